@@ -16,8 +16,8 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
   EventLoop _eventloop {};
   FileDescriptor _input { STDIN_FILENO };
   FileDescriptor _output { STDOUT_FILENO };
-  ByteStream _outbound { buffer_size };
-  ByteStream _inbound { buffer_size };
+  ByteStream _outbound { buffer_size, ByteStream::Mode::Mirrored }; // reads and writes never split at the wrap
+  ByteStream _inbound { buffer_size, ByteStream::Mode::Mirrored };
   bool _outbound_shutdown { false };
   bool _inbound_shutdown { false };
 
@@ -31,10 +31,8 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     _input,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _outbound.writer().available_capacity() );
-      _input.read( data );
-      _outbound.writer().push( move( data ) );
+      Writer& outbound = _outbound.writer();
+      outbound.commit( _input.read( outbound.reserve( outbound.available_capacity() ) ) );
       if ( _input.eof() ) {
         _outbound.writer().close();
       }
@@ -57,7 +55,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     Direction::Out,
     [&] {
       if ( _outbound.reader().bytes_buffered() ) {
-        _outbound.reader().pop( socket.write( _outbound.reader().peek() ) );
+        _outbound.reader().pop( socket.write( _outbound.reader().peek_all() ) );
       }
       if ( _outbound.reader().is_finished() ) {
         socket.shutdown( SHUT_WR );
@@ -81,10 +79,8 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     socket,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _inbound.writer().available_capacity() );
-      socket.read( data );
-      _inbound.writer().push( move( data ) );
+      Writer& inbound = _inbound.writer();
+      inbound.commit( socket.read( inbound.reserve( inbound.available_capacity() ) ) );
       if ( socket.eof() ) {
         _inbound.writer().close();
       }
@@ -107,7 +103,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     Direction::Out,
     [&] {
       if ( _inbound.reader().bytes_buffered() ) {
-        _inbound.reader().pop( _output.write( _inbound.reader().peek() ) );
+        _inbound.reader().pop( _output.write( _inbound.reader().peek_all() ) );
       }
       if ( _inbound.reader().is_finished() ) {
         _output.close();
@@ -127,9 +123,10 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     } );
 
   // loop until completion
-  while ( true ) {
-    if ( EventLoop::Result::Exit == _eventloop.wait_next_event( -1 ) ) {
-      return;
-    }
+  while ( EventLoop::Result::Exit != _eventloop.wait_next_event( -1 ) ) {}
+
+  if constexpr ( ByteStream::kCountStats ) {
+    cerr << "DEBUG: outbound stream stats: " << _outbound.stats().to_string() << "\n";
+    cerr << "DEBUG: inbound stream stats: " << _inbound.stats().to_string() << "\n";
   }
 }
@@ -6,3 +6,9 @@ set(SANITIZING_FLAGS -fno-sanitize-recover=all -fsanitize=undefined -fsanitize=a
 # ask for more warnings from the compiler
 set (CMAKE_BASE_CXX_FLAGS "${CMAKE_CXX_FLAGS}")
 set (CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -Wall -Wpedantic -Wextra -Werror -Wshadow -Wpointer-arith -Wcast-qual -Wformat=2 -Wno-unqualified-std-cast-call -Wno-non-virtual-dtor")
+
+# optional ByteStream instrumentation (see ByteStream::Stats)
+option(MINNOW_STREAM_STATS "Count ByteStream high-water mark, truncated pushes, empty reads and time spent full" OFF)
+if (MINNOW_STREAM_STATS)
+    add_compile_definitions(MINNOW_STREAM_STATS)
+endif ()
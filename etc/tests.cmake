@@ -18,6 +18,15 @@ ttest(byte_stream_one_write)
 ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
+ttest(byte_stream_chunks)
+ttest(byte_stream_reserve)
+ttest(byte_stream_mirrored)
+ttest(byte_stream_stats)
+ttest(byte_stream_spsc)
+
+ttest(broadcast_stream_basics)
+ttest(broadcast_stream_lag)
+ttest(broadcast_stream_stress_test)
 
 ttest(reassembler_single)
 ttest(reassembler_cap)
@@ -26,6 +35,7 @@ ttest(reassembler_dup)
 ttest(reassembler_holes)
 ttest(reassembler_overlapping)
 ttest(reassembler_win)
+ttest(reassembler_ring)
 
 ttest(wrapping_integers_cmp)
 ttest(wrapping_integers_wrap)
@@ -40,6 +50,11 @@ ttest(recv_reorder)
 ttest(recv_reorder_more)
 ttest(recv_close)
 ttest(recv_special)
+ttest(recv_zero_copy)
+ttest(recv_sack)
+ttest(recv_window_scale)
+ttest(recv_delayed_ack)
+ttest(recv_wrap)
 
 ttest(send_connect)
 ttest(send_transmit)
@@ -48,6 +63,18 @@ ttest(send_window)
 ttest(send_ack)
 ttest(send_close)
 ttest(send_extra)
+ttest(send_congestion)
+ttest(send_rtt)
+ttest(send_fast_retransmit)
+ttest(send_sack)
+ttest(send_mss)
+ttest(send_timestamps)
+ttest(send_nagle)
+ttest(send_rack_tlp)
+ttest(send_ecn)
+ttest(send_wrap)
+
+ttest(lossy_adapter_ecn)
 
 ttest(net_interface)
 
@@ -72,4 +99,9 @@ set_property(TEST ${compile_name_opt} PROPERTY TIMEOUT 0)
 set_tests_properties(${compile_name_opt} PROPERTIES FIXTURES_SETUP compile_opt)
 
 stest(byte_stream_speed_test)
+stest(byte_stream_spsc_speed_test)
 stest(reassembler_speed_test)
+stest(tcp_loss_speed_test)
+stest(tcp_window_speed_test)
+stest(tcp_pacing_speed_test)
+stest(tcp_ecn_speed_test)
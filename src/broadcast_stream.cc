@@ -0,0 +1,184 @@
+#include "broadcast_stream.hh"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+BroadcastStream::BroadcastStream( uint64_t capacity ) : buffer_( capacity, 0 ), capacity_( capacity ) {}
+
+size_t BroadcastStream::add_reader( uint64_t max_lag )
+{
+  if ( max_lag == 0 ) {
+    throw runtime_error( "BroadcastStream::add_reader(): a reader needs a positive lag limit" );
+  }
+  const Cursor cursor { .start = pushcnt_, .position = pushcnt_, .max_lag = max_lag };
+
+  const auto slot = ranges::find_if( cursors_, []( const Cursor& c ) { return c.removed; } );
+  if ( slot != cursors_.end() ) {
+    *slot = cursor;
+    return static_cast<size_t>( slot - cursors_.begin() );
+  }
+
+  cursors_.push_back( cursor );
+  return cursors_.size() - 1;
+}
+
+void BroadcastStream::remove_reader( size_t id )
+{
+  if ( id >= cursors_.size() or cursors_[id].removed ) {
+    throw runtime_error( "BroadcastStream::remove_reader(): no reader with id " + to_string( id ) );
+  }
+  cursors_[id].removed = true;
+  reclaim();
+}
+
+size_t BroadcastStream::reader_count() const
+{
+  return ranges::count_if( cursors_, []( const Cursor& c ) { return c.live(); } );
+}
+
+void BroadcastStream::reclaim()
+{
+  tail_ = pushcnt_;
+  for ( const auto& c : cursors_ ) {
+    if ( c.live() ) {
+      tail_ = min( tail_, c.position );
+    }
+  }
+}
+
+void BroadcastWriter::push( string_view data )
+{
+  // drop any reader that this push would leave too far behind; that frees space, so the push may grow and
+  // leave others too far behind in turn. The push is never longer than a lag limit, so only a reader that
+  // already had bytes waiting can be dropped.
+  uint64_t to_append = 0;
+  for ( bool evicted_any = true; evicted_any; ) {
+    to_append = min( available_capacity(), static_cast<uint64_t>( data.size() ) );
+    for ( const auto& c : cursors_ ) {
+      if ( c.live() ) {
+        to_append = min( to_append, c.max_lag );
+      }
+    }
+    evicted_any = false;
+    for ( auto& c : cursors_ ) {
+      if ( c.live() and pushcnt_ + to_append - c.position > c.max_lag ) {
+        c.evicted = true;
+        evicted_any = true;
+      }
+    }
+    if ( evicted_any ) {
+      reclaim();
+    }
+  }
+
+  if ( to_append == 0 ) {
+    return;
+  }
+
+  // copy into the ring, splitting the write in two if it runs past the end of the storage
+  const uint64_t write_pos = pushcnt_ % capacity_;
+  const uint64_t first_part = min( to_append, capacity_ - write_pos );
+  copy_n( data.data(), first_part, buffer_.data() + write_pos );
+  copy_n( data.data() + first_part, to_append - first_part, buffer_.data() );
+  pushcnt_ += to_append;
+
+  if ( reader_count() == 0 ) {
+    tail_ = pushcnt_; // nobody will read these bytes
+  }
+}
+
+void BroadcastWriter::close()
+{
+  is_closed_ = true;
+}
+
+bool BroadcastWriter::is_closed() const
+{
+  return is_closed_;
+}
+
+uint64_t BroadcastWriter::available_capacity() const
+{
+  return capacity_ - ( pushcnt_ - tail_ );
+}
+
+uint64_t BroadcastWriter::bytes_pushed() const
+{
+  return pushcnt_;
+}
+
+const BroadcastStream::Cursor& BroadcastReader::cursor() const
+{
+  if ( id_ >= stream_->cursors_.size() or stream_->cursors_[id_].removed ) {
+    throw runtime_error( "BroadcastReader: no reader with id " + to_string( id_ ) );
+  }
+  return stream_->cursors_[id_];
+}
+
+string_view BroadcastReader::peek() const
+{
+  const uint64_t buffered = bytes_buffered();
+  if ( buffered == 0 ) {
+    return {};
+  }
+
+  // only the part up to the end of the storage is contiguous; the rest is visible after the next pop
+  const uint64_t read_pos = cursor().position % stream_->capacity_;
+  return string_view( stream_->buffer_ ).substr( read_pos, min( buffered, stream_->capacity_ - read_pos ) );
+}
+
+void BroadcastReader::pop( uint64_t len )
+{
+  len = min( len, bytes_buffered() );
+  if ( len == 0 ) {
+    return;
+  }
+
+  const bool was_slowest = cursor().position == stream_->tail_;
+  stream_->cursors_[id_].position += len;
+  if ( was_slowest ) {
+    stream_->reclaim();
+  }
+}
+
+bool BroadcastReader::is_finished() const
+{
+  return stream_->is_closed_ and not is_evicted() and bytes_buffered() == 0;
+}
+
+bool BroadcastReader::is_evicted() const
+{
+  return cursor().evicted;
+}
+
+uint64_t BroadcastReader::bytes_buffered() const
+{
+  const auto& c = cursor();
+  return c.evicted ? 0 : stream_->pushcnt_ - c.position;
+}
+
+uint64_t BroadcastReader::bytes_popped() const
+{
+  const auto& c = cursor();
+  return c.position - c.start;
+}
+
+BroadcastWriter& BroadcastStream::writer()
+{
+  static_assert( sizeof( BroadcastWriter ) == sizeof( BroadcastStream ),
+                 "Please add member variables to the BroadcastStream base, not the BroadcastWriter." );
+
+  return static_cast<BroadcastWriter&>( *this ); // NOLINT(*-downcast)
+}
+
+const BroadcastWriter& BroadcastStream::writer() const
+{
+  return static_cast<const BroadcastWriter&>( *this ); // NOLINT(*-downcast)
+}
+
+BroadcastReader BroadcastStream::reader( size_t id )
+{
+  return { *this, id };
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class BroadcastWriter;
+class BroadcastReader;
+
+/*
+ * A ByteStream with one writer and any number of readers.
+ *
+ * Every reader sees the same bytes but has its own read cursor, so one copy of (say) a chat room's outbound
+ * traffic can feed every connection. The bytes live in a single ring of `capacity` bytes; space is reclaimed
+ * once the slowest reader has popped past it, and the writer is limited by that slowest reader.
+ *
+ * To keep one slow reader from stalling everyone, each reader has a lag limit: if a push would leave the
+ * reader more than `max_lag` bytes behind, the reader is evicted (its cursor is dropped and its space
+ * reclaimed) before the push. Its owner finds out from BroadcastReader::is_evicted(). A reader whose
+ * `max_lag` is at least the capacity is never evicted; it holds the writer back instead.
+ *
+ * Only a backlog gets a reader evicted, never the size of one push: a push is cut to the smallest `max_lag`
+ * of the live readers (like one cut to the available capacity, the caller pushes the rest later), so a
+ * reader that pops everything between pushes is never evicted.
+ */
+class BroadcastStream
+{
+public:
+  explicit BroadcastStream( uint64_t capacity );
+
+  // Add a reader, which starts at the current end of the stream (it sees only bytes pushed from now on).
+  // `max_lag` must be positive. Returns its id; the ids of removed readers may be reused.
+  size_t add_reader( uint64_t max_lag );
+  void remove_reader( size_t id ); // Forget a reader (evicted or not) and reclaim its space
+  size_t reader_count() const;     // Number of readers that are neither removed nor evicted
+
+  // Helper functions to access the stream's Writer interface and a Reader interface for each reader
+  BroadcastWriter& writer();
+  const BroadcastWriter& writer() const;
+  BroadcastReader reader( size_t id );
+
+  void set_error() { error_ = true; };       // Signal that the stream suffered an error.
+  bool has_error() const { return error_; }; // Has the stream had an error?
+
+protected:
+  friend class BroadcastReader;
+
+  struct Cursor
+  {
+    uint64_t start;    // stream offset the reader joined at
+    uint64_t position; // stream offset of the reader's next byte
+    uint64_t max_lag;  // evict the reader rather than let it fall further behind than this
+    bool evicted = false;
+    bool removed = false;
+
+    bool live() const { return not evicted and not removed; }
+  };
+
+  void reclaim(); // advance tail_ to the slowest live reader
+
+  std::string buffer_;             // fixed ring; byte n of the stream lives at buffer_[n % capacity_]
+  std::vector<Cursor> cursors_ {}; // indexed by reader id
+  uint64_t pushcnt_ = 0;           // total bytes ever pushed
+  uint64_t tail_ = 0;              // oldest byte still needed by some reader (== pushcnt_ if there are none)
+  bool is_closed_ = false;
+  uint64_t capacity_;
+  bool error_ {};
+};
+
+class BroadcastWriter : public BroadcastStream
+{
+public:
+  void push( std::string_view data ); // Push data to every reader, as much as capacity and lag limits allow.
+  void close();                       // Signal that the stream has reached its ending.
+
+  bool is_closed() const;              // Has the stream been closed?
+  uint64_t available_capacity() const; // How many bytes can be pushed right now (limited by the slowest reader)?
+  uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
+};
+
+// One reader's view of a BroadcastStream. Cheap to make; valid while the stream is.
+class BroadcastReader
+{
+public:
+  BroadcastReader( BroadcastStream& stream, size_t id ) : stream_( &stream ), id_( id ) {}
+
+  std::string_view peek() const; // Peek at the next contiguous bytes for this reader
+  void pop( uint64_t len );      // Remove `len` bytes from this reader's view of the stream
+
+  bool is_finished() const;        // Is the stream closed and fully popped by this reader?
+  bool is_evicted() const;         // Was this reader evicted for exceeding its lag limit?
+  uint64_t bytes_buffered() const; // Number of bytes pushed and not yet popped by this reader (its lag)
+  uint64_t bytes_popped() const;   // Total number of bytes this reader has popped
+
+private:
+  const BroadcastStream::Cursor& cursor() const;
+
+  BroadcastStream* stream_;
+  size_t id_;
+};
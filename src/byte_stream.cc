@@ -1,11 +1,27 @@
 #include "byte_stream.hh"
-#include <iostream>
+#include "exception.hh"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
 
 using namespace std;
 
-ByteStream::ByteStream( uint64_t capacity ) : capacity_( capacity )
+ByteStream::ByteStream( uint64_t capacity, Mode mode )
+  : mode_( mode ), ring_size_( capacity ), capacity_( capacity )
 {
-  bytes.reserve( capacity ); // reserve some space in the string
+  if ( mode_ == Mode::Mirrored ) {
+    try {
+      mirror_ = MirroredBuffer { capacity };
+      ring_size_ = mirror_.size();
+      return;
+    } catch ( const unix_error& ) {
+      mode_ = Mode::Ring; // no memfd or mmap here: same behavior, with a ring that wraps
+    }
+  }
+
+  if ( mode_ == Mode::Ring ) {
+    buffer_.assign( capacity, 0 );
+  }
 }
 
 bool Writer::is_closed() const
@@ -15,12 +31,76 @@ bool Writer::is_closed() const
 
 void Writer::push( string data )
 {
-  size_t space_left = capacity_ - currlen;
-  size_t to_append = std::min( space_left, data.size() );
+  const uint64_t requested = data.size();
+  const uint64_t to_append = std::min( available_capacity(), requested );
+  if ( to_append == 0 ) {
+    count_push( requested, 0 );
+    return;
+  }
 
-  bytes.append( data, 0, to_append ); // this avoids creation of another string
+  if ( mode_ == Mode::Chunks ) {
+    data.resize( to_append );
+    if ( data.capacity() > 2 * data.size() ) {
+      data.shrink_to_fit(); // don't let a mostly-empty read buffer pin its whole allocation while queued
+    }
+    chunks_.push_back( std::move( data ) );
+  } else if ( mode_ == Mode::Mirrored ) {
+    // may continue into the second mapping
+    std::copy_n( data.data(), to_append, mirror_.data() + pushcnt % ring_size_ );
+  } else {
+    // copy into the ring, splitting the write in two if it runs past the end of the storage
+    const uint64_t write_pos = pushcnt % ring_size_;
+    const uint64_t first_part = std::min( to_append, ring_size_ - write_pos );
+    std::copy_n( data.data(), first_part, buffer_.data() + write_pos );
+    std::copy_n( data.data() + first_part, to_append - first_part, buffer_.data() );
+  }
   pushcnt += to_append;
-  currlen += to_append;
+  count_push( requested, to_append );
+}
+
+span<char> Writer::reserve( uint64_t len )
+{
+  if constexpr ( kCountStats ) {
+    truncated_pushes_ += len > available_capacity();
+  }
+  len = std::min( len, available_capacity() );
+
+  if ( mode_ == Mode::Chunks ) {
+    reserved_chunk_.resize( len );
+    reserved_len_ = len;
+    return reserved_chunk_;
+  }
+
+  // hand out the free region after the write cursor, up to the end of the storage (or all of it, if mirrored)
+  if ( len == 0 ) {
+    reserved_len_ = 0;
+    return {};
+  }
+  const uint64_t write_pos = pushcnt % ring_size_;
+  if ( mode_ == Mode::Mirrored ) {
+    reserved_len_ = len;
+    return { mirror_.data() + write_pos, reserved_len_ };
+  }
+  reserved_len_ = std::min( len, ring_size_ - write_pos );
+  return { buffer_.data() + write_pos, reserved_len_ };
+}
+
+void Writer::commit( uint64_t len )
+{
+  if ( len > reserved_len_ ) {
+    throw std::runtime_error( "Writer::commit() of more bytes than were reserved" );
+  }
+  reserved_len_ = 0;
+
+  if ( mode_ == Mode::Chunks ) {
+    reserved_chunk_.resize( len );
+    push( std::move( reserved_chunk_ ) );
+    reserved_chunk_.clear();
+    return;
+  }
+
+  pushcnt += len; // the bytes are already in place
+  count_push( len, len );
 }
 
 void Writer::close()
@@ -30,7 +110,7 @@ void Writer::close()
 
 uint64_t Writer::available_capacity() const
 {
-  return capacity_ - currlen;
+  return capacity_ - ( pushcnt - popcnt );
 }
 
 uint64_t Writer::bytes_pushed() const
@@ -40,7 +120,7 @@ uint64_t Writer::bytes_pushed() const
 
 bool Reader::is_finished() const
 {
-  return is_closed_ and currlen == 0;
+  return is_closed_ and pushcnt == popcnt;
 }
 
 uint64_t Reader::bytes_popped() const
@@ -50,24 +130,137 @@ uint64_t Reader::bytes_popped() const
 
 string_view Reader::peek() const
 {
-  return std::string_view( bytes ).substr( 0 ); // doing this instead of returning bytes directly
+  if ( pushcnt == popcnt ) {
+    if constexpr ( kCountStats ) {
+      ++empty_reads_;
+    }
+    return {};
+  }
+
+  if ( mode_ == Mode::Chunks ) {
+    return std::string_view( chunks_.front() ).substr( front_offset_ );
+  }
+
+  const uint64_t read_pos = popcnt % ring_size_;
+  if ( mode_ == Mode::Mirrored ) {
+    return { mirror_.data() + read_pos, bytes_buffered() };
+  }
+
+  // only the part up to the end of the storage is contiguous; the rest is visible after the next pop
+  return std::string_view( buffer_ ).substr( read_pos, std::min( bytes_buffered(), ring_size_ - read_pos ) );
+}
+
+vector<string_view> Reader::peek_all() const
+{
+  vector<string_view> regions;
+  if ( pushcnt == popcnt ) {
+    if constexpr ( kCountStats ) {
+      ++empty_reads_;
+    }
+    return regions;
+  }
+
+  if ( mode_ == Mode::Chunks ) {
+    regions.reserve( chunks_.size() );
+    regions.push_back( peek() );
+    for ( auto it = next( chunks_.begin() ); it != chunks_.end(); ++it ) {
+      regions.emplace_back( *it );
+    }
+    return regions;
+  }
+
+  // at most two regions: up to the end of the storage, then the wrapped part from its start (never when mirrored)
+  regions.push_back( peek() );
+  if ( regions.front().size() < bytes_buffered() ) {
+    regions.push_back( string_view( buffer_ ).substr( 0, bytes_buffered() - regions.front().size() ) );
+  }
+  return regions;
+}
+
+string_view Reader::peek_from( uint64_t offset ) const
+{
+  if ( offset >= bytes_buffered() ) {
+    return {};
+  }
+
+  if ( mode_ == Mode::Chunks ) {
+    // find the chunk holding the byte, walking in from whichever end of the queue is nearer
+    if ( offset < bytes_buffered() / 2 ) {
+      offset += front_offset_;
+      for ( const string& chunk : chunks_ ) {
+        if ( offset < chunk.size() ) {
+          return string_view( chunk ).substr( offset );
+        }
+        offset -= chunk.size();
+      }
+    }
+    uint64_t from_end = bytes_buffered() - offset;
+    for ( auto it = chunks_.rbegin(); it != chunks_.rend(); ++it ) {
+      if ( from_end <= it->size() ) {
+        return string_view( *it ).substr( it->size() - from_end );
+      }
+      from_end -= it->size();
+    }
+    return {};
+  }
+
+  const uint64_t pos = ( popcnt + offset ) % ring_size_;
+  if ( mode_ == Mode::Mirrored ) {
+    return { mirror_.data() + pos, bytes_buffered() - offset };
+  }
+  return string_view( buffer_ ).substr( pos, std::min( bytes_buffered() - offset, ring_size_ - pos ) );
 }
 
 void Reader::pop( uint64_t len )
 {
-  if ( len >= currlen ) {
-    popcnt += currlen;
-    currlen = 0;
-    bytes = "";
-  } else {
-    popcnt += len;
-    bytes.erase(
-      0, len ); // erase also takes care of the case when len > bytes.size() and it does not create another string
-    currlen -= len;
+  len = std::min( len, bytes_buffered() );
+  if constexpr ( kCountStats ) {
+    if ( len > 0 and pushcnt - popcnt == capacity_ ) {
+      time_full_ += chrono::steady_clock::now() - full_since_;
+    }
+  }
+  popcnt += len; // no bytes move, the read cursor just advances
+
+  if ( mode_ == Mode::Chunks ) {
+    // drop every chunk that is now fully consumed, then skip into the new front one
+    while ( len > 0 and len >= chunks_.front().size() - front_offset_ ) {
+      len -= chunks_.front().size() - front_offset_;
+      chunks_.pop_front();
+      front_offset_ = 0;
+    }
+    front_offset_ += len;
   }
 }
 
 uint64_t Reader::bytes_buffered() const
 {
-  return currlen;
+  return pushcnt - popcnt;
+}
+
+void ByteStream::count_push( uint64_t requested, uint64_t pushed )
+{
+  if constexpr ( kCountStats ) {
+    truncated_pushes_ += pushed < requested;
+    high_water_mark_ = std::max( high_water_mark_, pushcnt - popcnt );
+    if ( pushed > 0 and pushcnt - popcnt == capacity_ ) {
+      full_since_ = chrono::steady_clock::now(); // this push filled the stream
+    }
+  }
+}
+
+ByteStream::Stats ByteStream::stats() const
+{
+  Stats stats { high_water_mark_, truncated_pushes_, empty_reads_, time_full_ };
+  if ( kCountStats and capacity_ > 0 and pushcnt - popcnt == capacity_ ) {
+    stats.time_full += chrono::steady_clock::now() - full_since_; // still full
+  }
+  return stats;
+}
+
+string ByteStream::Stats::to_string() const
+{
+  return "high_water_mark=" + std::to_string( high_water_mark )
+         + " truncated_pushes=" + std::to_string( truncated_pushes ) + " empty_reads="
+         + std::to_string( empty_reads ) + " time_full="
+         + std::to_string( chrono::duration_cast<chrono::milliseconds>( time_full ).count() ) + "ms";
 }
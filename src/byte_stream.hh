@@ -1,8 +1,14 @@
 #pragma once
 
+#include "mirrored_buffer.hh"
+
+#include <chrono>
 #include <cstdint>
+#include <deque>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 class Reader;
 class Writer;
@@ -10,7 +16,21 @@ class Writer;
 class ByteStream
 {
 public:
-  explicit ByteStream( uint64_t capacity );
+  // How the stream holds buffered bytes:
+  //   Ring:     copied into a fixed ring of `capacity` bytes, allocated up front.
+  //   Chunks:   the pushed strings themselves are kept (trimmed to capacity), so push never copies;
+  //             peek() then returns the remainder of the oldest pushed string.
+  //   Mirrored: a ring mapped twice back to back (see MirroredBuffer), so peek() always returns every
+  //             buffered byte as one view. Meant for large (1 MB+) streams; rounds the ring up to whole
+  //             pages, and falls back to Ring if the mapping can't be made.
+  enum class Mode : uint8_t
+  {
+    Ring,
+    Chunks,
+    Mirrored
+  };
+
+  explicit ByteStream( uint64_t capacity, Mode mode = Mode::Ring );
 
   // Helper functions (provided) to access the ByteStream's Reader and Writer interfaces
   Reader& reader();
@@ -21,16 +41,50 @@ public:
   void set_error() { error_ = true; };       // Signal that the stream suffered an error.
   bool has_error() const { return error_; }; // Has the stream had an error?
 
+  // Instrumentation, to tell whether a stream's capacity is what limits throughput. Only counted when built
+  // with -DMINNOW_STREAM_STATS=ON; otherwise the counters stay zero and cost nothing.
+#ifdef MINNOW_STREAM_STATS
+  static constexpr bool kCountStats = true;
+#else
+  static constexpr bool kCountStats = false;
+#endif
+
+  struct Stats
+  {
+    uint64_t high_water_mark {};                      // most bytes ever buffered at once
+    uint64_t truncated_pushes {};                     // pushes (or reserves) cut short by a full stream
+    uint64_t empty_reads {};                          // peeks that found nothing buffered
+    std::chrono::steady_clock::duration time_full {}; // total time spent with no available capacity
+
+    std::string to_string() const;
+  };
+
+  Stats stats() const;
+
 protected:
   // Please add any additional state to the ByteStream here, and not to the Writer and Reader interfaces.
   // this data will be shared between the Writer and Reader interfaces.
-  int pushcnt = 0;
-  int popcnt = 0;
-  std::string bytes = "";
-  uint64_t currlen = 0;
+  Mode mode_;
+  std::string buffer_;                // Ring mode: fixed ring; the readable region starts at popcnt % ring_size_
+  MirroredBuffer mirror_ {};          // Mirrored mode: the ring, readable past its end
+  uint64_t ring_size_ {};             // Ring/Mirrored modes: size of the ring (at least capacity_)
+  std::deque<std::string> chunks_ {}; // Chunks mode: pushed strings, oldest first
+  uint64_t front_offset_ = 0;         // Chunks mode: bytes already popped from chunks_.front()
+  std::string reserved_chunk_ {};     // Chunks mode: storage handed out by Writer::reserve, pushed on commit
+  uint64_t reserved_len_ = 0;         // size of the last Writer::reserve span not yet committed
+  uint64_t pushcnt = 0;    // total bytes ever pushed (also the ring's write cursor)
+  uint64_t popcnt = 0;     // total bytes ever popped (also the ring's read cursor)
   bool is_closed_ = false;
   uint64_t capacity_;
   bool error_ {};
+
+  // Instrumentation (see Stats); only updated if kCountStats
+  void count_push( uint64_t requested, uint64_t pushed );
+  uint64_t high_water_mark_ {};
+  uint64_t truncated_pushes_ {};
+  mutable uint64_t empty_reads_ {}; // counted by the const peek methods
+  std::chrono::steady_clock::duration time_full_ {};
+  std::chrono::steady_clock::time_point full_since_ {};
 };
 
 class Writer : public ByteStream
@@ -39,6 +93,11 @@ public:
   void push( std::string data ); // Push data to stream, but only as much as available capacity allows.
   void close();                  // Signal that the stream has reached its ending. Nothing more will be written.
 
+  // Zero-copy alternative to push: fill space in the stream's own storage, then make it readable.
+  // The reserved span is only valid until the next push, reserve, or commit.
+  std::span<char> reserve( uint64_t len ); // Writable space for up to `len` bytes (may be shorter, even empty)
+  void commit( uint64_t len );             // The first `len` bytes of the reserved space are now pushed
+
   bool is_closed() const;              // Has the stream been closed?
   uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
   uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
@@ -47,7 +106,9 @@ public:
 class Reader : public ByteStream
 {
 public:
-  std::string_view peek() const; // Peek at the next bytes in the buffer
+  std::string_view peek() const; // Peek at the next contiguous bytes in the buffer
+  std::vector<std::string_view> peek_all() const; // Peek at every buffered byte, as one view per region
+  std::string_view peek_from( uint64_t offset ) const; // Peek at the contiguous bytes `offset` past the next one
   void pop( uint64_t len );      // Remove `len` bytes from the buffer
 
   bool is_finished() const;        // Is the stream finished (closed and fully popped)?
@@ -60,3 +121,9 @@ public:
  * from a ByteStream Reader into a string;
  */
 void read( Reader& reader, uint64_t len, std::string& out );
+
+/*
+ * peek_at: copies up to `len` bytes, starting `offset` bytes after the next one
+ * to be read, from a ByteStream Reader into a string (without popping them)
+ */
+void peek_at( const Reader& reader, uint64_t offset, uint64_t len, std::string& out );
@@ -11,11 +11,14 @@ void read( Reader& reader, uint64_t len, std::string& out )
 {
   out.clear();
 
-  while ( reader.bytes_buffered() and out.size() < len ) {
+  while ( out.size() < len ) {
     auto view = reader.peek();
 
     if ( view.empty() ) {
-      throw std::runtime_error( "Reader::peek() returned empty string_view" );
+      if ( reader.bytes_buffered() ) {
+        throw std::runtime_error( "Reader::peek() returned empty string_view" );
+      }
+      break; // nothing (more) to read
     }
 
     view = view.substr( 0, len - out.size() ); // Don't return more bytes than desired.
@@ -24,6 +27,23 @@ void read( Reader& reader, uint64_t len, std::string& out )
   }
 }
 
+/*
+ * peek_at: copies up to `len` bytes, starting `offset` bytes after the next one
+ * to be read, from a ByteStream Reader into a string (without popping them)
+ */
+void peek_at( const Reader& reader, uint64_t offset, uint64_t len, std::string& out )
+{
+  out.clear();
+
+  while ( out.size() < len ) {
+    const std::string_view region = reader.peek_from( offset + out.size() );
+    if ( region.empty() ) {
+      break; // nothing (more) buffered there
+    }
+    out += region.substr( 0, len - out.size() );
+  }
+}
+
 Reader& ByteStream::reader()
 {
   static_assert( sizeof( Reader ) == sizeof( ByteStream ),
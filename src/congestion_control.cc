@@ -0,0 +1,126 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+CongestionController::CongestionController( uint64_t mss )
+  : mss_( mss ), cwnd_( INITIAL_WINDOW * mss )
+{}
+
+void CongestionController::set_mss( uint64_t mss )
+{
+  if ( cwnd_ == INITIAL_WINDOW * mss_ and ssthresh_ == UINT64_MAX ) {
+    cwnd_ = INITIAL_WINDOW * mss;
+  }
+  mss_ = mss;
+}
+
+void CongestionController::on_loss( uint64_t bytes_in_flight, uint64_t /* now_ms */ )
+{
+  ssthresh_ = max( bytes_in_flight / 2, 2 * mss_ );
+  cwnd_ = ssthresh_;
+}
+
+void CongestionController::on_timeout( uint64_t bytes_in_flight )
+{
+  ssthresh_ = max( bytes_in_flight / 2, 2 * mss_ );
+  cwnd_ = mss_;
+}
+
+void CongestionController::slow_start( uint64_t bytes_acked )
+{
+  cwnd_ = min( cwnd_ + min( bytes_acked, 2 * mss_ ), max( ssthresh_, cwnd_ ) );
+}
+
+void NewReno::on_ack( uint64_t bytes_acked, uint64_t /* now_ms */, uint64_t /* rtt_ms */ )
+{
+  if ( in_slow_start() ) {
+    slow_start( bytes_acked );
+    return;
+  }
+
+  // congestion avoidance: one MSS per cwnd of acknowledged data
+  bytes_acked_ += bytes_acked;
+  if ( bytes_acked_ >= cwnd_ ) {
+    bytes_acked_ -= cwnd_;
+    cwnd_ += mss_;
+  }
+}
+
+void NewReno::on_loss( uint64_t bytes_in_flight, uint64_t now_ms )
+{
+  CongestionController::on_loss( bytes_in_flight, now_ms );
+  bytes_acked_ = 0;
+}
+
+void Cubic::on_ack( uint64_t bytes_acked, uint64_t now_ms, uint64_t rtt_ms )
+{
+  if ( in_slow_start() ) {
+    slow_start( bytes_acked );
+    return;
+  }
+
+  const auto mss = static_cast<double>( mss_ );
+  auto cwnd = static_cast<double>( cwnd_ );
+
+  if ( not epoch_start_ms_.has_value() ) {
+    epoch_start_ms_ = now_ms;
+    origin_ = max( w_max_, cwnd );
+    k_ = cbrt( ( origin_ - cwnd ) / mss / C );
+    w_est_ = cwnd;
+  }
+
+  // where the cubic curve says the window should be one RTT from now (at most 1.5 * cwnd)
+  const double t = static_cast<double>( now_ms - *epoch_start_ms_ + rtt_ms ) / 1000.0;
+  const double target = clamp( origin_ + C * pow( t - k_, 3 ) * mss, cwnd, 1.5 * cwnd );
+
+  // the Reno-friendly estimate, so CUBIC is never slower than Reno would be on short-RTT paths
+  w_est_ += 3 * ( 1 - BETA ) / ( 1 + BETA ) * static_cast<double>( bytes_acked ) * mss / cwnd;
+
+  if ( w_est_ > target ) {
+    growth_ += w_est_ - cwnd;
+  } else {
+    growth_ += ( target - cwnd ) / cwnd * static_cast<double>( bytes_acked );
+  }
+  const auto whole = static_cast<uint64_t>( growth_ );
+  cwnd_ += whole;
+  growth_ -= static_cast<double>( whole );
+}
+
+void Cubic::on_loss( uint64_t /* bytes_in_flight */, uint64_t /* now_ms */ )
+{
+  reduce();
+  cwnd_ = ssthresh_;
+}
+
+void Cubic::on_timeout( uint64_t /* bytes_in_flight */ )
+{
+  reduce();
+  cwnd_ = mss_;
+}
+
+void Cubic::reduce()
+{
+  const auto cwnd = static_cast<double>( cwnd_ );
+
+  // fast convergence: if the window never got back to the last maximum, release some bandwidth to newcomers
+  w_max_ = cwnd < w_max_ ? cwnd * ( 1 + BETA ) / 2 : cwnd;
+  ssthresh_ = max( static_cast<uint64_t>( cwnd * BETA ), 2 * mss_ );
+  epoch_start_ms_.reset();
+  growth_ = 0;
+}
+
+unique_ptr<CongestionController> make_congestion_controller( TCPConfig::CongestionControl algorithm, uint64_t mss )
+{
+  switch ( algorithm ) {
+    case TCPConfig::CongestionControl::NewReno:
+      return make_unique<NewReno>( mss );
+    case TCPConfig::CongestionControl::Cubic:
+      return make_unique<Cubic>( mss );
+    case TCPConfig::CongestionControl::None:
+      break;
+  }
+  return nullptr;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "tcp_config.hh"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+/*
+ * The congestion-control half of a TCPSender.
+ *
+ * The sender reports events (new data acknowledged, a loss detected, the retransmission timer expiring) and
+ * may have at most `cwnd()` sequence numbers in flight, on top of the limit set by the receiver's window.
+ * All sizes are in bytes; times are the sender's clock in milliseconds.
+ */
+class CongestionController
+{
+public:
+  explicit CongestionController( uint64_t mss );
+  virtual ~CongestionController() = default;
+
+  // `bytes_acked` new bytes were acknowledged. `rtt_ms` is the current smoothed RTT (0 if not yet known).
+  virtual void on_ack( uint64_t bytes_acked, uint64_t now_ms, uint64_t rtt_ms ) = 0;
+
+  // A loss was detected while `bytes_in_flight` were outstanding (other than by the timer expiring)
+  virtual void on_loss( uint64_t bytes_in_flight, uint64_t now_ms );
+
+  // The retransmission timer expired while `bytes_in_flight` were outstanding
+  virtual void on_timeout( uint64_t bytes_in_flight );
+
+  virtual std::string_view name() const = 0;
+
+  // The sender's MSS changed (e.g. once the SYNs have been exchanged). An initial window not yet grown is resized.
+  void set_mss( uint64_t mss );
+
+  uint64_t cwnd() const { return cwnd_; }         // congestion window
+  uint64_t ssthresh() const { return ssthresh_; } // slow-start threshold
+  bool in_slow_start() const { return cwnd_ < ssthresh_; }
+
+  static constexpr uint64_t INITIAL_WINDOW = 10; // segments (RFC 6928)
+
+protected:
+  void slow_start( uint64_t bytes_acked ); // grow cwnd by up to 2 * MSS per ACK (RFC 3465, L = 2)
+
+  uint64_t mss_;
+  uint64_t cwnd_;
+  uint64_t ssthresh_ = UINT64_MAX;
+};
+
+// RFC 5681 slow start and congestion avoidance
+class NewReno : public CongestionController
+{
+public:
+  using CongestionController::CongestionController;
+
+  void on_ack( uint64_t bytes_acked, uint64_t now_ms, uint64_t rtt_ms ) override;
+  void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  std::string_view name() const override { return "NewReno"; }
+
+private:
+  uint64_t bytes_acked_ {}; // acknowledged bytes not yet credited to cwnd in congestion avoidance
+};
+
+// RFC 9438: after a loss, the window follows a cubic function of the time since the loss, so it regains the
+// previous maximum quickly, probes carefully around it, and grows independently of the RTT.
+class Cubic : public CongestionController
+{
+public:
+  using CongestionController::CongestionController;
+
+  void on_ack( uint64_t bytes_acked, uint64_t now_ms, uint64_t rtt_ms ) override;
+  void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_timeout( uint64_t bytes_in_flight ) override;
+  std::string_view name() const override { return "CUBIC"; }
+
+  static constexpr double C = 0.4;    // scaling constant, in segments per second cubed
+  static constexpr double BETA = 0.7; // multiplicative decrease factor
+
+private:
+  void reduce(); // the loss response shared by on_loss and on_timeout
+
+  double w_max_ {};                           // cwnd just before the last reduction (bytes)
+  double w_est_ {};                           // what Reno would have grown cwnd to since then (bytes)
+  double k_ {};                               // seconds from the epoch start until the window reaches origin_
+  double origin_ {};                          // the window size the curve plateaus at (bytes)
+  double growth_ {};                          // fractional bytes of growth not yet added to cwnd
+  std::optional<uint64_t> epoch_start_ms_ {}; // start of the current congestion-avoidance epoch
+};
+
+// Make the controller `algorithm` selects (nullptr for TCPConfig::CongestionControl::None)
+std::unique_ptr<CongestionController> make_congestion_controller( TCPConfig::CongestionControl algorithm,
+                                                                  uint64_t mss );
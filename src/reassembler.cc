@@ -1,77 +1,108 @@
 #include "reassembler.hh"
-#include <iostream>
-#include <map>
 
-void Reassembler::insert( uint64_t first_index, std::string data, bool is_last_substring )
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+void Reassembler::insert( uint64_t first_index, string data, bool is_last_substring )
 {
-  if ( first_index >= curr_index + writer().available_capacity() ) {
-    return;
+  if ( is_last_substring ) {
+    last_index = first_index + data.size();
   }
 
-  if ( first_index < curr_index ) {
-    if ( first_index + data.size() <= curr_index ) {
-      return;
+  // keep only the part that lies within [curr_index, first unacceptable index)
+  const uint64_t begin = max( first_index, curr_index );
+  const uint64_t end = min( first_index + data.size(), curr_index + writer().available_capacity() );
+  if ( begin < end ) {
+    data.resize( end - first_index );
+    data.erase( 0, begin - first_index );
+
+    if ( begin == curr_index ) {
+      output_.writer().push( move( data ) );
+      curr_index = writer().bytes_pushed();
+      flush();
+    } else {
+      store( begin, move( data ) );
     }
-    data = data.substr( curr_index - first_index );
-    first_index = curr_index;
   }
 
-  if ( first_index > curr_index ) {
-    uint64_t possible_length = curr_index + writer().available_capacity() - first_index;
-    if ( possible_length > data.size() ) {
-      possible_length = data.size();
+  if ( last_index == curr_index ) {
+    output_.writer().close();
+  }
+}
+
+void Reassembler::store( uint64_t first_index, string data )
+{
+  last_stored = first_index;
+  uint64_t end = first_index + data.size();
+
+  // an earlier substring that runs into this one: keep its bytes, drop ours
+  auto it = pending_data.upper_bound( first_index );
+  if ( it != pending_data.begin() ) {
+    const auto& [prev_first, prev_data] = *prev( it );
+    const uint64_t prev_end = prev_first + prev_data.size();
+    if ( prev_end >= end ) {
+      return; // nothing new
     }
-    if ( pending_data.find( first_index ) != pending_data.end() ) {
-      if ( pending_data[first_index].size() < possible_length ) {
-        pending_data[first_index] = data.substr( 0, possible_length );
-      }
-    } else {
-      pending_data[first_index] = data.substr( 0, possible_length );
+    if ( prev_end > first_index ) {
+      data.erase( 0, prev_end - first_index );
+      first_index = prev_end;
     }
-  } else if ( first_index == curr_index ) {
-    uint64_t previous_push = writer().bytes_pushed();
-    output_.writer().push( data );
-    uint64_t pushed = writer().bytes_pushed() - previous_push;
-    curr_index += pushed;
-    for ( auto it = pending_data.begin(); it != pending_data.end(); ) {
-      if ( it->first == curr_index ) {
-        previous_push = writer().bytes_pushed();
-        output_.writer().push( it->second );
-        pushed = writer().bytes_pushed() - previous_push;
-        curr_index += pushed;
-        it = pending_data.erase( it );
-      } else if ( it->first < curr_index ) {
-        if ( it->first + it->second.size() - 1 >= curr_index ) {
-          previous_push = writer().bytes_pushed();
-          output_.writer().push( it->second.substr( curr_index - it->first ) );
-          pushed = writer().bytes_pushed() - previous_push;
-          curr_index += pushed;
-          it = pending_data.erase( it );
-        } else {
-          it = pending_data.erase( it );
-        }
-      } else {
-        ++it;
-      }
+  }
+
+  // later substrings: drop those this one covers, and cut this one short at the first that runs past its end
+  while ( it != pending_data.end() and it->first < end ) {
+    const uint64_t it_end = it->first + it->second.size();
+    if ( it_end > end ) {
+      data.resize( it->first - first_index );
+      end = it->first;
+      break;
     }
+    pending_bytes -= it->second.size();
+    it = pending_data.erase( it );
   }
 
-  if ( is_last_substring ) {
-    last_index = first_index + data.size();
+  if ( not data.empty() ) {
+    pending_bytes += data.size();
+    pending_data.emplace_hint( it, first_index, move( data ) );
   }
+}
 
-  if ( last_index == curr_index )
-    output_.writer().close();
+vector<pair<uint64_t, uint64_t>> Reassembler::pending_ranges( size_t max_ranges ) const
+{
+  // stored substrings are disjoint, but may abut
+  vector<pair<uint64_t, uint64_t>> ranges;
+  for ( const auto& [first, data] : pending_data ) {
+    if ( not ranges.empty() and ranges.back().second == first ) {
+      ranges.back().second += data.size();
+    } else {
+      ranges.emplace_back( first, first + data.size() );
+    }
+  }
+
+  const auto latest = find_if( ranges.begin(), ranges.end(), [&]( const auto& r ) {
+    return r.first <= last_stored and last_stored < r.second;
+  } );
+  if ( latest != ranges.end() ) {
+    rotate( ranges.begin(), latest, next( latest ) );
+  }
+
+  ranges.resize( min( ranges.size(), max_ranges ) );
+  return ranges;
 }
 
-uint64_t Reassembler::bytes_pending() const
+void Reassembler::flush()
 {
-  // Your code here.
-  std::map<uint64_t, bool> count;
-  for ( auto it : pending_data ) {
-    for ( uint64_t i = 0; i < it.second.size(); i++ ) {
-      count[it.first + i] = true;
+  while ( not pending_data.empty() and pending_data.begin()->first <= curr_index ) {
+    auto node = pending_data.extract( pending_data.begin() );
+    pending_bytes -= node.mapped().size();
+
+    const uint64_t skip = curr_index - node.key(); // bytes already pushed by a longer, later substring
+    if ( skip < node.mapped().size() ) {
+      node.mapped().erase( 0, skip );
+      output_.writer().push( move( node.mapped() ) );
+      curr_index = writer().bytes_pushed();
     }
   }
-  return count.size();
 }
@@ -2,6 +2,8 @@
 
 #include "byte_stream.hh"
 #include <map>
+#include <utility>
+#include <vector>
 
 class Reassembler
 {
@@ -34,7 +36,11 @@ public:
   void insert( uint64_t first_index, std::string data, bool is_last_substring );
 
   // How many bytes are stored in the Reassembler itself?
-  uint64_t bytes_pending() const;
+  uint64_t bytes_pending() const { return pending_bytes; }
+
+  // The ranges [first, end) of indices stored in the Reassembler (for SACK), at most `max_ranges` of them.
+  // The range holding the most recently inserted substring comes first; the rest follow in index order.
+  std::vector<std::pair<uint64_t, uint64_t>> pending_ranges( size_t max_ranges ) const;
 
   // Access output stream reader
   Reader& reader() { return output_.reader(); }
@@ -45,8 +51,13 @@ public:
   const Writer& writer() const { return output_.writer(); }
 
 private:
+  void store( uint64_t first_index, std::string data ); // add to pending_data, trimming away bytes already there
+  void flush();                                         // push every pending byte that is now next in line
+
   ByteStream output_; // the Reassembler writes to this ByteStream
-  std::map<uint64_t, std::string> pending_data {};
-  uint64_t curr_index = 0;
+  std::map<uint64_t, std::string> pending_data {}; // disjoint substrings beyond curr_index, keyed by first index
+  uint64_t pending_bytes = 0;                      // total size of pending_data
+  uint64_t curr_index = 0;                         // index of the next byte to push
   uint64_t last_index = -1;
+  uint64_t last_stored = -1; // first index of the most recent substring that had to be stored
 };
@@ -0,0 +1,113 @@
+#include "ring_reassembler.hh"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+using namespace std;
+
+RingReassembler::RingReassembler( ByteStream&& output )
+  : output_( move( output ) )
+  , ring_size_( ( writer().available_capacity() + kWordBits - 1 ) / kWordBits * kWordBits )
+  , ring_( ring_size_ )
+  , bits_( ring_size_ / kWordBits )
+{}
+
+void RingReassembler::insert( uint64_t first_index, string data, bool is_last_substring )
+{
+  if ( is_last_substring ) {
+    last_index_ = first_index + data.size();
+  }
+
+  // keep only the part that lies within [curr_index_, first unacceptable index)
+  const uint64_t begin = max( first_index, curr_index_ );
+  const uint64_t end = min( first_index + data.size(), curr_index_ + writer().available_capacity() );
+  if ( begin < end ) {
+    if ( begin == curr_index_ and pending_bytes_ == 0 ) {
+      // in order with nothing stored: the data can go to the stream as it is
+      data.resize( end - first_index );
+      data.erase( 0, begin - first_index );
+      output_.writer().push( move( data ) );
+      curr_index_ = end;
+    } else {
+      pending_bytes_ += store( begin % ring_size_, string_view( data ).substr( begin - first_index, end - begin ) );
+      if ( begin == curr_index_ ) {
+        flush();
+      }
+    }
+  }
+
+  if ( last_index_ == curr_index_ ) {
+    output_.writer().close();
+  }
+}
+
+void RingReassembler::flush()
+{
+  const uint64_t pos = curr_index_ % ring_size_;
+  const uint64_t len = present_from( pos );
+
+  // copy the run (at most two pieces, if it wraps around the ring) into the stream's own storage
+  for ( uint64_t done = 0; done < len; ) {
+    const uint64_t src = ( pos + done ) % ring_size_;
+    const auto space = output_.writer().reserve( min( len - done, ring_size_ - src ) );
+    if ( space.empty() ) {
+      throw runtime_error( "RingReassembler: output stream has less room than the window" );
+    }
+    copy_n( ring_.data() + src, space.size(), space.data() );
+    output_.writer().commit( space.size() );
+    done += space.size();
+  }
+
+  unmark( pos, len );
+  pending_bytes_ -= len;
+  curr_index_ += len;
+}
+
+uint64_t RingReassembler::store( uint64_t pos, string_view data )
+{
+  // a bitmap word (64 bytes of the ring) at a time; words whose bytes are all present already are skipped
+  uint64_t newly_set = 0;
+  while ( not data.empty() ) {
+    const uint64_t bit = pos % kWordBits;
+    const uint64_t n = min( static_cast<uint64_t>( data.size() ), kWordBits - bit );
+    const uint64_t mask = ( n == kWordBits ? ~uint64_t {} : ( uint64_t { 1 } << n ) - 1 ) << bit;
+    uint64_t& word = bits_[pos / kWordBits];
+    if ( const uint64_t missing = mask & ~word ) {
+      copy_n( data.data(), n, ring_.data() + pos );
+      newly_set += popcount( missing );
+      word |= mask;
+    }
+    pos = ( pos + n ) % ring_size_; // the ring is whole words, so data wraps only at a word boundary
+    data.remove_prefix( n );
+  }
+  return newly_set;
+}
+
+void RingReassembler::unmark( uint64_t pos, uint64_t len )
+{
+  while ( len > 0 ) {
+    const uint64_t bit = pos % kWordBits;
+    const uint64_t n = min( len, kWordBits - bit );
+    const uint64_t mask = ( n == kWordBits ? ~uint64_t {} : ( uint64_t { 1 } << n ) - 1 ) << bit;
+    bits_[pos / kWordBits] &= ~mask;
+    pos = ( pos + n ) % ring_size_;
+    len -= n;
+  }
+}
+
+uint64_t RingReassembler::present_from( uint64_t pos ) const
+{
+  // a word at a time: count the set bits from `pos` up, stopping at the first clear one
+  uint64_t run = 0;
+  while ( run < pending_bytes_ ) {
+    const uint64_t bit = pos % kWordBits;
+    const auto ones = static_cast<uint64_t>( countr_one( bits_[pos / kWordBits] >> bit ) );
+    run += ones;
+    if ( ones < kWordBits - bit ) {
+      break;
+    }
+    pos = ( pos + ones ) % ring_size_;
+  }
+  return min( run, pending_bytes_ );
+}
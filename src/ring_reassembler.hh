@@ -0,0 +1,52 @@
+#pragma once
+
+#include "byte_stream.hh"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * A drop-in alternative to Reassembler for heavily reordered input.
+ *
+ * Out-of-order bytes are copied straight into a ring sized to the output stream's capacity (the largest the
+ * window can ever be), and a bitmap records which of them have arrived. When the next byte in line arrives,
+ * the contiguous run of present bytes is found a 64-bit word at a time and copied into the ByteStream in one
+ * reserve/commit. There is no per-substring allocation, and memory is a fixed function of capacity.
+ */
+class RingReassembler
+{
+public:
+  // Construct RingReassembler to write into given (empty) ByteStream.
+  explicit RingReassembler( ByteStream&& output );
+
+  // Same contract as Reassembler::insert
+  void insert( uint64_t first_index, std::string data, bool is_last_substring );
+
+  // How many bytes are stored in the RingReassembler itself?
+  uint64_t bytes_pending() const { return pending_bytes_; }
+
+  // Access output stream reader
+  Reader& reader() { return output_.reader(); }
+  const Reader& reader() const { return output_.reader(); }
+
+  // Access output stream writer, but const-only (can't write from outside)
+  const Writer& writer() const { return output_.writer(); }
+
+private:
+  static constexpr uint64_t kWordBits = 64;
+
+  uint64_t store( uint64_t pos, std::string_view data ); // copy into the ring at pos and mark; returns # new bytes
+  void unmark( uint64_t pos, uint64_t len );              // clear bits [pos, pos + len) of the ring
+  uint64_t present_from( uint64_t pos ) const;            // length of the run of set bits starting at pos
+  void flush();                                           // push the run of present bytes from curr_index_
+
+  ByteStream output_;          // the RingReassembler writes to this ByteStream
+  uint64_t ring_size_;         // the stream's capacity, rounded up to a whole bitmap word
+  std::vector<char> ring_;     // byte n of the stream is stored at ring_[n % ring_size_] until it is pushed
+  std::vector<uint64_t> bits_; // bit n % ring_size_ is set if byte n is stored in ring_
+  uint64_t pending_bytes_ = 0; // number of set bits
+  uint64_t curr_index_ = 0;    // index of the next byte to push
+  uint64_t last_index_ = -1;
+};
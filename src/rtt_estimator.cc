@@ -0,0 +1,28 @@
+#include "rtt_estimator.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+RTTEstimator::RTTEstimator( uint64_t initial_RTO_ms, uint64_t min_RTO_ms, uint64_t max_RTO_ms )
+  : min_RTO_ms_( min_RTO_ms ), max_RTO_ms_( max_RTO_ms ), RTO_ms_( initial_RTO_ms )
+{}
+
+void RTTEstimator::sample( uint64_t rtt_ms )
+{
+  const auto r = static_cast<double>( rtt_ms );
+  if ( srtt_.has_value() ) {
+    rttvar_ = ( 1 - BETA ) * rttvar_ + BETA * abs( *srtt_ - r ); // uses the old SRTT, so update it second
+    srtt_ = ( 1 - ALPHA ) * *srtt_ + ALPHA * r;
+  } else {
+    srtt_ = r;
+    rttvar_ = r / 2;
+  }
+
+  latest_rtt_ = rtt_ms;
+  min_rtt_ = min( min_rtt_.value_or( rtt_ms ), rtt_ms );
+
+  const auto rto = static_cast<uint64_t>( ceil( *srtt_ + max( G, 4 * rttvar_ ) ) );
+  RTO_ms_ = clamp( rto, min_RTO_ms_, max_RTO_ms_ );
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+/*
+ * Round-trip time estimation and retransmission timeout, as in RFC 6298.
+ *
+ * Each sample updates a smoothed RTT (SRTT) and its mean deviation (RTTVAR), and the RTO is
+ * SRTT + 4 * RTTVAR, kept within [min_RTO_ms, max_RTO_ms]. Until the first sample, the RTO is the initial one.
+ * Callers must only pass unambiguous samples (Karn's rule: never from a retransmitted segment).
+ */
+class RTTEstimator
+{
+public:
+  RTTEstimator( uint64_t initial_RTO_ms, uint64_t min_RTO_ms, uint64_t max_RTO_ms );
+
+  void sample( uint64_t rtt_ms ); // Add a round-trip time measurement
+
+  uint64_t RTO_ms() const { return RTO_ms_; }         // Current retransmission timeout (before any backoff)
+  uint64_t max_RTO_ms() const { return max_RTO_ms_; } // Upper bound on the RTO, including backoff
+  bool has_samples() const { return srtt_.has_value(); }
+
+  // The estimates, in milliseconds (0 before the first sample)
+  double srtt() const { return srtt_.value_or( 0 ); }
+  double rttvar() const { return rttvar_; }
+  uint64_t latest_rtt() const { return latest_rtt_; }
+  uint64_t min_rtt() const { return min_rtt_.value_or( 0 ); }
+
+private:
+  static constexpr double ALPHA = 1.0 / 8; // gain for SRTT
+  static constexpr double BETA = 1.0 / 4;  // gain for RTTVAR
+  static constexpr double G = 1;           // clock granularity, in milliseconds
+
+  uint64_t min_RTO_ms_;
+  uint64_t max_RTO_ms_;
+  uint64_t RTO_ms_;
+  std::optional<double> srtt_ {};
+  double rttvar_ {};
+  uint64_t latest_rtt_ {};
+  std::optional<uint64_t> min_rtt_ {};
+};
@@ -0,0 +1,50 @@
+#include "sack_scoreboard.hh"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+void SACKScoreboard::add( uint64_t first, uint64_t end )
+{
+  if ( first >= end ) {
+    return;
+  }
+
+  // absorb every block that overlaps or touches [first, end)
+  auto it = blocks_.upper_bound( first );
+  if ( it != blocks_.begin() and prev( it )->second >= first ) {
+    --it;
+  }
+  while ( it != blocks_.end() and it->first <= end ) {
+    first = min( first, it->first );
+    end = max( end, it->second );
+    it = blocks_.erase( it );
+  }
+  blocks_.emplace_hint( it, first, end );
+}
+
+void SACKScoreboard::advance( uint64_t ackno )
+{
+  while ( not blocks_.empty() and blocks_.begin()->first < ackno ) {
+    auto node = blocks_.extract( blocks_.begin() );
+    if ( node.mapped() > ackno ) {
+      blocks_.emplace( ackno, node.mapped() );
+    }
+  }
+}
+
+bool SACKScoreboard::covers( uint64_t first, uint64_t end ) const
+{
+  auto it = blocks_.upper_bound( first );
+  return it != blocks_.begin() and prev( it )->second >= end;
+}
+
+uint64_t SACKScoreboard::bytes_above( uint64_t seqno ) const
+{
+  uint64_t total = 0;
+  for ( auto it = blocks_.rbegin(); it != blocks_.rend() and it->second > seqno; ++it ) {
+    total += it->second - max( it->first, seqno );
+  }
+  return total;
+}
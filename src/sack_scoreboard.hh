@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+/*
+ * A TCPSender's record of the sequence numbers beyond the ackno that the receiver has selectively
+ * acknowledged (RFC 2018). Sequence numbers are absolute; blocks are kept disjoint and merged when they touch.
+ */
+class SACKScoreboard
+{
+public:
+  void add( uint64_t first, uint64_t end ); // Record a SACK block [first, end)
+  void advance( uint64_t ackno );           // Forget everything below the cumulative ackno
+  void clear() { blocks_.clear(); }
+
+  bool covers( uint64_t first, uint64_t end ) const; // Has all of [first, end) been SACKed?
+  uint64_t bytes_above( uint64_t seqno ) const;      // How many SACKed sequence numbers are at or past `seqno`?
+  bool empty() const { return blocks_.empty(); }
+
+private:
+  std::map<uint64_t, uint64_t> blocks_ {}; // first -> end
+};
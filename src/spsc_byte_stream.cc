@@ -0,0 +1,197 @@
+#include "spsc_byte_stream.hh"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+SPSCByteStream::SPSCByteStream( uint64_t capacity )
+  : capacity_( capacity ), buffer_( make_unique<char[]>( capacity ) ) // NOLINT(*-avoid-c-arrays)
+{}
+
+void SPSCByteStream::set_error()
+{
+  error_.store( true, memory_order_release );
+  readable_.notify();
+  writable_.notify();
+}
+
+bool SPSCByteStream::has_error() const
+{
+  return error_.load( memory_order_acquire );
+}
+
+uint64_t SPSCWriter::push( string_view data )
+{
+  const auto space = reserve( data.size() );
+  copy_n( data.data(), space.size(), space.data() );
+  commit( space.size() );
+
+  // the free space may continue from the start of the storage
+  if ( space.size() < data.size() ) {
+    const auto rest = reserve( data.size() - space.size() );
+    copy_n( data.data() + space.size(), rest.size(), rest.data() );
+    commit( rest.size() );
+    return space.size() + rest.size();
+  }
+  return space.size();
+}
+
+span<char> SPSCWriter::reserve( uint64_t len )
+{
+  len = min( len, available_capacity() );
+  if ( len == 0 ) {
+    reserved_len_ = 0;
+    return {};
+  }
+
+  const uint64_t write_pos = pushcnt_.load( memory_order_relaxed ) % capacity_;
+  reserved_len_ = min( len, capacity_ - write_pos );
+  return { buffer_.get() + write_pos, reserved_len_ };
+}
+
+void SPSCWriter::commit( uint64_t len )
+{
+  if ( len > reserved_len_ ) {
+    throw runtime_error( "SPSCWriter::commit() of more bytes than were reserved" );
+  }
+  reserved_len_ = 0;
+  if ( len == 0 ) {
+    return;
+  }
+
+  // the bytes written into the ring become visible to the reader along with the new count
+  pushcnt_.store( pushcnt_.load( memory_order_relaxed ) + len );
+  if ( reader_waiting_.exchange( false ) ) {
+    readable_.notify();
+  }
+}
+
+void SPSCWriter::close()
+{
+  is_closed_.store( true );
+  if ( reader_waiting_.exchange( false ) ) {
+    readable_.notify();
+  }
+}
+
+// The waiting flag and the counters are all sequentially consistent: either the reader's re-check sees the new
+// push count, or the writer's exchange sees the flag and notifies. A wakeup can't be lost in between.
+bool SPSCWriter::request_wakeup()
+{
+  writer_waiting_.store( true );
+  if ( available_capacity() > 0 or has_error() ) {
+    writer_waiting_.store( false );
+    return false;
+  }
+  return true;
+}
+
+bool SPSCWriter::is_closed() const
+{
+  return is_closed_.load( memory_order_relaxed );
+}
+
+uint64_t SPSCWriter::available_capacity() const
+{
+  return capacity_ - ( pushcnt_.load( memory_order_relaxed ) - popcnt_.load() );
+}
+
+uint64_t SPSCWriter::bytes_pushed() const
+{
+  return pushcnt_.load( memory_order_relaxed );
+}
+
+string_view SPSCReader::peek() const
+{
+  const uint64_t buffered = bytes_buffered();
+  if ( buffered == 0 ) {
+    return {};
+  }
+
+  const uint64_t read_pos = popcnt_.load( memory_order_relaxed ) % capacity_;
+  return { buffer_.get() + read_pos, min( buffered, capacity_ - read_pos ) };
+}
+
+vector<string_view> SPSCReader::peek_all() const
+{
+  vector<string_view> regions;
+  const uint64_t buffered = bytes_buffered();
+  if ( buffered == 0 ) {
+    return regions;
+  }
+
+  const uint64_t read_pos = popcnt_.load( memory_order_relaxed ) % capacity_;
+  const uint64_t first_part = min( buffered, capacity_ - read_pos );
+  regions.emplace_back( buffer_.get() + read_pos, first_part );
+  if ( first_part < buffered ) {
+    regions.emplace_back( buffer_.get(), buffered - first_part );
+  }
+  return regions;
+}
+
+void SPSCReader::pop( uint64_t len )
+{
+  len = min( len, bytes_buffered() );
+  if ( len == 0 ) {
+    return;
+  }
+
+  // the writer may reuse the freed bytes only after this thread is done reading them
+  popcnt_.store( popcnt_.load( memory_order_relaxed ) + len );
+  if ( writer_waiting_.exchange( false ) ) {
+    writable_.notify();
+  }
+}
+
+bool SPSCReader::request_wakeup()
+{
+  reader_waiting_.store( true );
+  if ( bytes_buffered() > 0 or is_closed_.load() or has_error() ) {
+    reader_waiting_.store( false );
+    return false;
+  }
+  return true;
+}
+
+bool SPSCReader::is_finished() const
+{
+  // the writer closes only after its last commit, so a closed stream's push count is final
+  return is_closed_.load( memory_order_acquire ) and bytes_buffered() == 0;
+}
+
+uint64_t SPSCReader::bytes_buffered() const
+{
+  return pushcnt_.load() - popcnt_.load( memory_order_relaxed );
+}
+
+uint64_t SPSCReader::bytes_popped() const
+{
+  return popcnt_.load( memory_order_relaxed );
+}
+
+SPSCReader& SPSCByteStream::reader()
+{
+  static_assert( sizeof( SPSCReader ) == sizeof( SPSCByteStream ),
+                 "Please add member variables to the SPSCByteStream base, not the SPSCReader." );
+
+  return static_cast<SPSCReader&>( *this ); // NOLINT(*-downcast)
+}
+
+const SPSCReader& SPSCByteStream::reader() const
+{
+  return static_cast<const SPSCReader&>( *this ); // NOLINT(*-downcast)
+}
+
+SPSCWriter& SPSCByteStream::writer()
+{
+  static_assert( sizeof( SPSCWriter ) == sizeof( SPSCByteStream ),
+                 "Please add member variables to the SPSCByteStream base, not the SPSCWriter." );
+
+  return static_cast<SPSCWriter&>( *this ); // NOLINT(*-downcast)
+}
+
+const SPSCWriter& SPSCByteStream::writer() const
+{
+  return static_cast<const SPSCWriter&>( *this ); // NOLINT(*-downcast)
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "eventfd.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+class SPSCReader;
+class SPSCWriter;
+
+/*
+ * A ByteStream that may be written by one thread while another thread reads it.
+ *
+ * The storage is a fixed ring like ByteStream's. The writer owns the push counter and the reader owns the pop
+ * counter; each publishes its own counter atomically and reads the other's, so neither side takes a lock.
+ * Exactly one thread may use writer() and exactly one (other) thread may use reader() at a time.
+ *
+ * Each side also has an eventfd the other side notifies, so a thread can sleep in poll until the stream becomes
+ * readable or writable again. To keep the common path free of system calls, an eventfd is only notified when
+ * its thread asked for it: before sleeping, call request_wakeup() and sleep only if it returns true.
+ *   - readable_event() is then notified by the next push, commit, or close
+ *   - writable_event() is then notified by the next pop that frees space
+ * set_error() always notifies both.
+ */
+class SPSCByteStream
+{
+public:
+  explicit SPSCByteStream( uint64_t capacity );
+
+  // Helper functions to access the stream's Reader and Writer interfaces
+  SPSCReader& reader();
+  const SPSCReader& reader() const;
+  SPSCWriter& writer();
+  const SPSCWriter& writer() const;
+
+  void set_error();       // Signal that the stream suffered an error (from either thread).
+  bool has_error() const; // Has the stream had an error?
+
+  EventFD& readable_event() { return readable_; } // Polled by the reader thread
+  EventFD& writable_event() { return writable_; } // Polled by the writer thread
+
+  // The two threads share the object by address, so it can be neither copied nor moved
+  SPSCByteStream( const SPSCByteStream& other ) = delete;
+  SPSCByteStream& operator=( const SPSCByteStream& other ) = delete;
+  SPSCByteStream( SPSCByteStream&& other ) = delete;
+  SPSCByteStream& operator=( SPSCByteStream&& other ) = delete;
+  ~SPSCByteStream() = default;
+
+protected:
+  // Cache-line-sized alignment keeps the two threads' counters from false sharing.
+  static constexpr size_t kCacheLine = 64;
+
+  uint64_t capacity_;
+  std::unique_ptr<char[]> buffer_; // NOLINT(*-avoid-c-arrays)
+
+  alignas( kCacheLine ) std::atomic<uint64_t> pushcnt_ { 0 }; // written only by the writer thread
+  std::atomic<bool> is_closed_ { false };                     // written only by the writer thread
+  std::atomic<bool> writer_waiting_ { false };                // writer is (about to be) asleep on writable_
+  uint64_t reserved_len_ { 0 };                               // writer: uncommitted Writer::reserve span
+
+  alignas( kCacheLine ) std::atomic<uint64_t> popcnt_ { 0 }; // written only by the reader thread
+  std::atomic<bool> reader_waiting_ { false };               // reader is (about to be) asleep on readable_
+
+  alignas( kCacheLine ) std::atomic<bool> error_ { false };
+
+  EventFD readable_ {};
+  EventFD writable_ {};
+};
+
+class SPSCWriter : public SPSCByteStream
+{
+public:
+  uint64_t push( std::string_view data ); // Push as much of `data` as fits; returns the number of bytes pushed
+  void close();                           // Signal that the stream has reached its ending.
+
+  std::span<char> reserve( uint64_t len ); // Writable space for up to `len` bytes (may be shorter, even empty)
+  void commit( uint64_t len );             // The first `len` bytes of the reserved space are now pushed
+
+  bool is_closed() const;              // Has the stream been closed?
+  uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
+  uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
+
+  // Ask the reader to notify writable_event() once it frees space. Returns false (and withdraws the request)
+  // if there is already space, in which case the caller should not sleep.
+  bool request_wakeup();
+};
+
+class SPSCReader : public SPSCByteStream
+{
+public:
+  std::string_view peek() const;                  // Peek at the next contiguous bytes in the buffer
+  std::vector<std::string_view> peek_all() const; // Peek at every buffered byte, as one view per region
+  void pop( uint64_t len );                       // Remove `len` bytes from the buffer
+
+  bool is_finished() const;        // Is the stream finished (closed and fully popped)?
+  uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
+  uint64_t bytes_popped() const;   // Total number of bytes cumulatively popped from stream
+
+  // Ask the writer to notify readable_event() once it pushes or closes. Returns false (and withdraws the
+  // request) if there is already something to read, in which case the caller should not sleep.
+  bool request_wakeup();
+};
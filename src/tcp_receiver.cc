@@ -7,6 +7,9 @@ void TCPReceiver::receive( TCPSenderMessage message )
   if ( message.SYN ) {
     zero_point = message.seqno;
     ackno = message.seqno + 1;
+    sack_permitted = message.sack_permitted;
+    window_shift_ = ( window_scale_ and message.window_scale ) ? *window_scale_ : 0;
+    timestamps_ = message.timestamp.has_value();
   }
 
   if ( message.RST )
@@ -14,16 +17,34 @@ void TCPReceiver::receive( TCPSenderMessage message )
 
   if ( !zero_point.has_value() )
     return;
-  uint64_t stream_index = message.seqno.unwrap( zero_point.value(), 0 ) - 1;
+  // unwrapped near the first unassembled byte, so that the stream index keeps counting past 2^32
+  uint64_t stream_index = message.seqno.unwrap( zero_point.value(), reassembler_.writer().bytes_pushed() + 1 ) - 1;
   if ( message.SYN )
     stream_index++;
 
+  if ( timestamps_ and message.timestamp.has_value() ) {
+    const bool newer = not ts_recent_ or static_cast<int32_t>( *message.timestamp - *ts_recent_ ) >= 0;
+    // PAWS: a timestamp older than the last one echoed marks an old duplicate from before the seqnos wrapped
+    if ( not newer and not message.RST ) {
+      return;
+    }
+    // echo the timestamp of the segment that fills the left edge of the window (not later, out-of-order ones)
+    if ( newer and stream_index <= reassembler_.writer().bytes_pushed() ) {
+      ts_recent_ = message.timestamp;
+    }
+  }
+
+  // RFC 3168: echo a CE mark on every ACK until the peer's sender says it has reduced its window
+  if ( message.CWR ) {
+    ece_ = false;
+  }
+  if ( message.ecn == ECN::CE ) {
+    ece_ = true;
+  }
+
   uint32_t prior = reassembler_.writer().bytes_pushed();
 
-  if ( message.FIN )
-    reassembler_.insert( stream_index, message.payload, true );
-  else
-    reassembler_.insert( stream_index, message.payload, false );
+  reassembler_.insert( stream_index, std::move( message.payload ), message.FIN );
 
   ackno = ackno.value() + ( static_cast<uint32_t>( reassembler_.writer().bytes_pushed() ) - prior );
   if ( reassembler_.writer().is_closed() )
@@ -35,10 +56,21 @@ TCPReceiverMessage TCPReceiver::send() const
   TCPReceiverMessage message;
   if ( ackno.has_value() )
     message.ackno = ackno.value();
-  uint64_t ws = reassembler_.writer().available_capacity();
+  uint64_t ws = reassembler_.writer().available_capacity() >> window_shift_;
   if ( ws > UINT16_MAX )
     ws = UINT16_MAX;
   message.window_size = ws;
   message.RST = reassembler_.reader().has_error();
+  message.ECE = ece_;
+  if ( timestamps_ ) {
+    message.timestamp_echo = ts_recent_;
+  }
+  if ( sack_permitted and zero_point.has_value() ) {
+    for ( const auto& [first, end] : reassembler_.pending_ranges( TCPReceiverMessage::MAX_SACK_BLOCKS ) ) {
+      // stream index 0 is the byte after the SYN
+      message.sack_blocks.emplace_back( Wrap32::wrap( first + 1, *zero_point ),
+                                        Wrap32::wrap( end + 1, *zero_point ) );
+    }
+  }
   return message;
 }
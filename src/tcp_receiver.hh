@@ -3,6 +3,8 @@
 #include "reassembler.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
+
+#include <cstdint>
 #include <optional>
 
 class TCPReceiver
@@ -11,6 +13,11 @@ public:
   // Construct with given Reassembler
   explicit TCPReceiver( Reassembler&& reassembler ) : reassembler_( std::move( reassembler ) ) {}
 
+  // Construct with given Reassembler, offering to advertise windows scaled down by `window_scale` bits (RFC 7323)
+  TCPReceiver( Reassembler&& reassembler, std::optional<uint8_t> window_scale )
+    : reassembler_( std::move( reassembler ) ), window_scale_( window_scale )
+  {}
+
   /*
    * The TCPReceiver receives TCPSenderMessages, inserting their payload into the Reassembler
    * at the correct stream index.
@@ -30,4 +37,10 @@ private:
   Reassembler reassembler_;
   std::optional<Wrap32> zero_point {};
   std::optional<Wrap32> ackno {};
+  bool sack_permitted {};                  // did the peer's SYN ask for selective acknowledgments?
+  std::optional<uint8_t> window_scale_ {}; // the shift count our SYN offers
+  uint8_t window_shift_ {};                // the one in use: zero unless the peer's SYN offered scaling too
+  bool timestamps_ {};                     // did the peer's SYN carry the timestamps option?
+  std::optional<uint32_t> ts_recent_ {};   // the TSval to echo (RFC 7323's TS.Recent)
+  bool ece_ {};                            // a CE mark arrived that the peer hasn't answered with CWR
 };
@@ -6,13 +6,7 @@ using namespace std;
 
 uint64_t TCPSender::sequence_numbers_in_flight() const
 {
-  uint64_t start = 0;
-  uint64_t end = 0;
-  if ( !outstanding_msg.empty() ) {
-    start = outstanding_msg.front().seqno.unwrap( isn_, 0 );
-    end = ( outstanding_msg.back().seqno + outstanding_msg.back().sequence_length() ).unwrap( isn_, 0 );
-  }
-  return end - start;
+  return in_flight_;
 }
 
 uint64_t TCPSender::consecutive_retransmissions() const
@@ -20,76 +14,562 @@ uint64_t TCPSender::consecutive_retransmissions() const
   return consecutive_ret;
 }
 
-void TCPSender::push( const TransmitFunction& transmit )
+uint64_t TCPSender::congestion_window() const
+{
+  return cc_ ? cc_->cwnd() : UINT64_MAX;
+}
+
+uint64_t TCPSender::slow_start_threshold() const
+{
+  return cc_ ? cc_->ssthresh() : UINT64_MAX;
+}
+
+uint64_t TCPSender::current_RTO_ms() const
+{
+  return RTO;
+}
+
+uint64_t TCPSender::base_RTO() const
+{
+  return rtt_ ? rtt_->RTO_ms() : initial_RTO_ms_;
+}
+
+bool TCPSender::in_fast_recovery() const
+{
+  return recovery_point_.has_value();
+}
+
+double TCPSender::pacing_rate() const
+{
+  if ( not pacing_ or not cc_ or not rtt_ or not rtt_->has_samples() ) {
+    return 0;
+  }
+  const double gain = cc_->in_slow_start() ? PACING_SS_GAIN : PACING_CA_GAIN;
+  return gain * static_cast<double>( cc_->cwnd() ) / max( rtt_->srtt(), 1.0 );
+}
+
+bool TCPSender::finished_sending() const
+{
+  return input_.writer().is_closed() and next_index_ == input_.writer().bytes_pushed();
+}
+
+uint64_t TCPSender::effective_window( uint64_t in_network ) const
+{
+  if ( window_size == 0 ) {
+    return 1;
+  }
+  if ( cc_ and sack_recovery() ) {
+    // RFC 6675: a new segment may go out once cwnd exceeds the pipe (in_network) by a full segment
+    const uint64_t room = cc_->cwnd() >= in_network + max_payload() ? cc_->cwnd() - in_network : 0;
+    return min( window_size, sequence_numbers_in_flight() + room );
+  }
+  if ( cc_ ) {
+    return min( window_size, cc_->cwnd() + inflation_ );
+  }
+  return window_size;
+}
+
+bool TCPSender::sack_recovery() const
+{
+  return recovery_point_ and peer_sacks_;
+}
+
+bool TCPSender::is_lost( const Segment& seg ) const
+{
+  return seg.lost or scoreboard_.bytes_above( seg.end() ) > ( DUP_ACK_THRESHOLD - 1 ) * max_payload();
+}
+
+uint64_t TCPSender::pipe() const
+{
+  uint64_t total = 0;
+  for ( const auto& seg : outstanding_ ) {
+    if ( scoreboard_.covers( seg.first, seg.end() ) ) {
+      continue;
+    }
+    if ( not is_lost( seg ) ) {
+      total += seg.length; // the original may still be on its way
+    }
+    if ( retransmitted_.contains( seg.first ) ) {
+      total += seg.length; // and so may the retransmission
+    }
+  }
+  return total;
+}
+
+void TCPSender::retransmit_holes( uint64_t& in_network )
+{
+  const uint64_t cwnd = congestion_window();
+  // the lost segments come first, SACKed ones aside: anything after one that isn't lost has even less SACKed
+  // above it, and was sent later
+  for ( Segment& seg : outstanding_ ) {
+    if ( scoreboard_.covers( seg.first, seg.end() ) ) {
+      continue;
+    }
+    if ( not is_lost( seg ) ) {
+      break;
+    }
+    if ( retransmitted_.contains( seg.first ) ) {
+      continue;
+    }
+    if ( in_network >= cwnd ) {
+      break;
+    }
+    in_network += seg.length; // the original was lost, so only the retransmission adds to the pipe
+    retransmitted_.insert( seg.first );
+    rtt_probe_.reset();
+    batch_.push_back( resend( seg ) );
+  }
+}
+
+uint64_t TCPSender::max_payload() const
+{
+  return peer_timestamps_ ? mss_ - TCPConfig::TIMESTAMPS_SPACE : mss_;
+}
+
+void TCPSender::stamp( TCPSenderMessage& msg ) const
+{
+  if ( msg.SYN ? timestamps_ : peer_timestamps_ ) {
+    msg.timestamp = static_cast<uint32_t>( now_ms_ );
+  }
+}
+
+TCPSenderMessage TCPSender::make_message( const Segment& seg ) const
 {
   TCPSenderMessage msg;
-  if ( seqno == isn_ ) {
-    msg.SYN = true;
-  }
-  msg.seqno = seqno;
-  uint64_t temp_window_size = window_size;
-  if ( temp_window_size == 0 )
-    temp_window_size = 1;
-  uint64_t payload_size = min( temp_window_size - sequence_numbers_in_flight(), TCPConfig::MAX_PAYLOAD_SIZE );
-  msg.payload = input_.reader().peek().substr( 0, payload_size );
-  input_.reader().pop( payload_size );
-  if ( input_.reader().is_finished()
-       and ( (int64_t)temp_window_size - (int64_t)sequence_numbers_in_flight() - (int64_t)msg.sequence_length() )
-             > 0
-       and !FIN_SENT ) {
-    msg.FIN = true;
-    FIN_SENT = true;
+  msg.seqno = Wrap32::wrap( seg.first, isn_ );
+  msg.SYN = seg.SYN;
+  if ( seg.SYN ) {
+    msg.mss = mss_option_;
+    msg.sack_permitted = sack_;
+    msg.window_scale = window_scale_;
+    msg.ecn_setup = ecn_ and peer_ecn_.value_or( true );
   }
-  if ( input_.has_error() ) {
-    msg.RST = true;
+  // the payload's stream index, less everything acknowledged (and so popped) before it
+  const uint64_t offset = seg.first + seg.SYN - 1 - input_.reader().bytes_popped();
+  peek_at( input_.reader(), offset, seg.payload_size(), msg.payload );
+  msg.FIN = seg.FIN;
+  msg.RST = input_.has_error();
+  if ( peer_ecn_.value_or( false ) and seg.payload_size() > 0 and not seg.resent ) {
+    msg.ecn = ECN::ECT0; // but not pure ACKs, SYNs or retransmissions (RFC 3168 6.1.4, 6.1.5)
   }
-  if ( msg.sequence_length() != 0 ) {
-    outstanding_msg.push( msg );
-    seqno = seqno + msg.sequence_length();
-    transmit( msg );
+  stamp( msg );
+  return msg;
+}
+
+TCPSenderMessage TCPSender::resend( Segment& seg )
+{
+  seg.sent_ms = now_ms_;
+  seg.resent = true;
+  return make_message( seg );
+}
+
+bool TCPSender::holds_back( const Segment& seg ) const
+{
+  if ( seg.SYN or seg.FIN or seg.payload_size() >= max_payload() ) {
+    return false;
+  }
+  const bool cork_expired = cork_deadline_ and now_ms_ >= *cork_deadline_;
+  return ( corked_ and not cork_expired ) or ( nagle_ and not nodelay_ and in_flight_ > 0 );
+}
+
+void TCPSender::push( const TransmitFunction& transmit )
+{
+  push( BatchTransmitFunction { [&]( Batch batch ) {
+    for ( const TCPSenderMessage& msg : batch ) {
+      transmit( msg );
+    }
+  } } );
+}
+
+void TCPSender::push( const BatchTransmitFunction& transmit )
+{
+  if ( retransmit_pending_ ) {
+    retransmit_pending_ = false;
+    if ( !outstanding_.empty() ) {
+      batch_.push_back( resend( outstanding_.front() ) );
+    }
+  }
+  // the pipe is counted once per push (so once per ACK), then kept up to date as segments go out
+  uint64_t in_network = sack_recovery() ? pipe() : 0;
+  if ( sack_recovery() ) {
+    retransmit_holes( in_network );
+  }
+
+  // new segments until the window is full, every buffered byte has been sent (or the rest is held back), or the
+  // pacing budget is spent
+  const bool paced = pacing_rate() > 0;
+  bool held_back = false;
+  while ( not paced or pacing_budget_ > 0 ) {
+    const uint64_t window = max( effective_window( in_network ), in_flight_ );
+    const uint64_t unsent = input_.reader().bytes_buffered() - ( next_index_ - input_.reader().bytes_popped() );
+    const uint64_t payload_size = min( { window - in_flight_, max_payload(), unsent } );
+    Segment seg { next_seqno_, payload_size, next_seqno_ == 0, false, now_ms_, false, false };
+    seg.length += seg.SYN;
+    if ( input_.writer().is_closed() and payload_size == unsent and window > in_flight_ + seg.length
+         and !FIN_SENT ) {
+      seg.FIN = true;
+      ++seg.length;
+      FIN_SENT = true;
+    }
+    if ( seg.length == 0 ) {
+      break;
+    }
+    if ( holds_back( seg ) ) {
+      held_back = true;
+      if ( corked_ and not cork_deadline_ ) {
+        cork_deadline_ = now_ms_ + CORK_TIMEOUT_MS;
+      }
+      break;
+    }
+
+    next_index_ += payload_size;
+    next_seqno_ += seg.length;
+    in_flight_ += seg.length;
+    in_network += seg.length;
+    if ( rtt_ and not rtt_probe_ and not peer_timestamps_ ) {
+      rtt_probe_ = RTTProbe { seg.end(), now_ms_ };
+    }
+    if ( paced ) {
+      pacing_budget_ -= static_cast<double>( seg.length );
+    }
+    if ( outstanding_.empty() ) {
+      timer = 0; // the retransmission timer starts with the first outstanding segment, not at the last ACK
+    }
+    probe_start_ms_ = now_ms_;
+    outstanding_.push_back( seg );
+    batch_.push_back( make_message( seg ) );
+    if ( cwr_pending_ and payload_size > 0 ) {
+      batch_.back().CWR = true;
+      cwr_pending_ = false;
+    }
+    if ( window <= in_flight_ or payload_size == unsent ) {
+      break;
+    }
+  }
+  if ( not held_back ) {
+    cork_deadline_.reset(); // the next partial segment the cork holds gets its own 200 ms
+  }
+
+  if ( !batch_.empty() ) {
+    transmit( batch_ );
+    batch_.clear(); // the payloads are only needed again if lost, and then they are read back from the stream
   }
-  if ( temp_window_size - sequence_numbers_in_flight() > 0 and !input_.reader().peek().empty() )
-    push( transmit );
 }
 
 TCPSenderMessage TCPSender::make_empty_message() const
 {
   TCPSenderMessage msg;
-  msg.seqno = seqno;
+  msg.seqno = Wrap32::wrap( next_seqno_, isn_ );
   if ( input_.has_error() ) {
     msg.RST = true;
   }
+  stamp( msg );
   return msg;
 }
 
 void TCPSender::receive( const TCPReceiverMessage& msg )
 {
-  window_size = msg.window_size;
+  const uint64_t previous_window_size = window_size;
+  window_size = static_cast<uint64_t>( msg.window_size ) << peer_window_shift_;
   if ( msg.RST )
     input_.reader().set_error();
-  if ( !msg.ackno.has_value() or msg.ackno.value().unwrap( isn_, 0 ) > seqno.unwrap( isn_, 0 ) )
+  // unwrapped near what has been sent, so that the ackno keeps counting past 2^32
+  if ( !msg.ackno.has_value() or msg.ackno.value().unwrap( isn_, next_seqno_ ) > next_seqno_ )
+    return;
+  const uint64_t ackno = msg.ackno.value().unwrap( isn_, next_seqno_ );
+  if ( sack_ ) {
+    record_sacks( msg );
+  }
+  bool ece_response = false;
+  if ( msg.ECE and peer_ecn_.value_or( false ) and ackno > ecn_recover_ ) {
+    // a router marked congestion: respond as to a loss (unless recovering from one already), with nothing lost
+    if ( cc_ and not recovery_point_ ) {
+      cc_->on_loss( sequence_numbers_in_flight(), now_ms_ );
+      ece_response = true;
+    }
+    ecn_recover_ = next_seqno_;
+    cwr_pending_ = true;
+  }
+  bool acked_any = false;
+  uint64_t bytes_acked = 0;
+  while ( !outstanding_.empty() && outstanding_.front().end() <= ackno ) {
+    const Segment& seg = outstanding_.front();
+    if ( rack_ ) {
+      rack_update( seg );
+    }
+    bytes_acked += seg.payload_size();
+    input_.reader().pop( seg.payload_size() ); // acknowledged, so never needed again
+    in_flight_ -= seg.length;
+    outstanding_.pop_front();
+    acked_any = true;
+  }
+  if ( tlp_ and ackno >= tlp_->end ) {
+    // Without DSACK, there's no telling whether the probe repaired a loss or only duplicated a late segment, so
+    // take it as a loss (RFC 8985 7.4) unless recovery has responded already
+    if ( cc_ and not recovery_point_ ) {
+      cc_->on_loss( tlp_->in_flight, now_ms_ );
+    }
+    tlp_.reset();
+  }
+  if ( rack_ ) {
+    if ( not msg.sack_blocks.empty() ) {
+      for ( const Segment& seg : outstanding_ ) {
+        if ( scoreboard_.covers( seg.first, seg.end() ) ) {
+          rack_update( seg );
+        }
+      }
+    }
+    rack_detect_losses();
+  }
+  if ( !acked_any ) {
+    // RFC 5681: an ACK is a duplicate if data is outstanding and it moves neither the ackno nor the window
+    if ( fast_retransmit_ and !outstanding_.empty() and ackno == outstanding_.front().first
+         and window_size == previous_window_size ) {
+      on_duplicate_ack();
+    }
+    return;
+  }
+  dup_acks_ = 0;
+
+  if ( rtt_ and peer_timestamps_ and msg.timestamp_echo ) {
+    // the echo says when the segment that prompted this ACK was sent, even if it was a retransmission
+    rtt_->sample( static_cast<uint32_t>( now_ms_ ) - *msg.timestamp_echo );
+  } else if ( rtt_probe_ and ackno >= rtt_probe_->end ) {
+    rtt_->sample( now_ms_ - rtt_probe_->sent_ms );
+    rtt_probe_.reset();
+  }
+  consecutive_ret = 0;
+  RTO = base_RTO();
+  timer = 0;
+  probe_start_ms_ = now_ms_;
+
+  if ( recovery_point_ ) {
+    if ( ackno >= *recovery_point_ ) {
+      // full ACK: recovery is over, and cwnd is left at ssthresh
+      recovery_point_.reset();
+      inflation_ = 0;
+      retransmitted_.clear();
+    } else if ( not sack_recovery() ) {
+      // partial ACK: the segment after the acknowledged ones was lost too. Resend it, and deflate the window
+      // by what was acknowledged (but let one new segment out in its place).
+      // (With SACK, retransmit_holes() decides what to resend.)
+      retransmit_pending_ = true;
+      inflation_ = ( inflation_ > bytes_acked ? inflation_ - bytes_acked : 0 ) + max_payload();
+    }
+    return;
+  }
+
+  if ( cc_ and bytes_acked > 0 and not ece_response ) {
+    cc_->on_ack( bytes_acked, now_ms_, rtt_ ? static_cast<uint64_t>( rtt_->srtt() ) : 0 );
+  }
+}
+
+void TCPSender::record_sacks( const TCPReceiverMessage& msg )
+{
+  const uint64_t ackno = msg.ackno.value().unwrap( isn_, next_seqno_ );
+  scoreboard_.advance( ackno );
+  for ( const auto& [left, right] : msg.sack_blocks ) {
+    const uint64_t first = left.unwrap( isn_, ackno );
+    const uint64_t end = right.unwrap( isn_, ackno );
+    if ( first < end and end <= next_seqno_ ) { // ignore blocks for sequence numbers never sent
+      scoreboard_.add( max( first, ackno ), end );
+      peer_sacks_ = true;
+    }
+  }
+}
+
+void TCPSender::on_duplicate_ack()
+{
+  ++dup_acks_;
+  if ( sack_recovery() ) {
+    return; // the pipe accounts for what the SACK blocks say has left the network
+  }
+  if ( recovery_point_ ) {
+    // each further duplicate means another segment has left the network, so one more may be sent
+    inflation_ += max_payload();
+    return;
+  }
+
+  // RFC 6675 also starts recovery as soon as enough has been SACKed above the first segment to deem it lost
+  const uint64_t ackno = outstanding_.front().first;
+  if ( ( dup_acks_ < DUP_ACK_THRESHOLD and not is_lost( outstanding_.front() ) ) or ackno <= recover_ ) {
     return;
-  while ( !outstanding_msg.empty()
-          && ( outstanding_msg.front().seqno + outstanding_msg.front().sequence_length() ).unwrap( isn_, 0 )
-               <= msg.ackno.value().unwrap( isn_, 0 ) ) {
-    outstanding_msg.pop();
-    consecutive_ret = 0;
-    RTO = initial_RTO_ms_;
-    timer = 0;
+  }
+  enter_recovery();
+}
+
+void TCPSender::enter_recovery()
+{
+  // fast retransmit, then fast recovery until everything sent so far is acknowledged
+  recovery_point_ = recover_ = next_seqno_;
+  if ( cc_ ) {
+    if ( outstanding_.front().first >= ecn_recover_ ) { // not sent before the window was reduced for an ECE
+      cc_->on_loss( sequence_numbers_in_flight(), now_ms_ );
+    }
+    if ( not peer_sacks_ ) {
+      inflation_ = DUP_ACK_THRESHOLD * max_payload();
+    }
+  }
+  if ( peer_sacks_ ) {
+    retransmitted_.insert( outstanding_.front().first );
+  }
+  retransmit_pending_ = true;
+  rtt_probe_.reset();
+}
+
+void TCPSender::rack_update( const Segment& seg )
+{
+  // an ACK this soon after a retransmission is probably for the original (RFC 8985 6.2)
+  if ( seg.resent and now_ms_ - seg.sent_ms < rtt_->min_rtt() ) {
+    return;
+  }
+  if ( seg.sent_ms > rack_sent_ms_ or ( seg.sent_ms == rack_sent_ms_ and seg.end() > rack_end_ ) ) {
+    rack_sent_ms_ = seg.sent_ms;
+    rack_end_ = seg.end();
+    rack_rtt_ = now_ms_ - seg.sent_ms;
+  }
+}
+
+bool TCPSender::sent_before_rack( const Segment& seg ) const
+{
+  return seg.sent_ms < rack_sent_ms_ or ( seg.sent_ms == rack_sent_ms_ and seg.end() < rack_end_ );
+}
+
+void TCPSender::rack_detect_losses()
+{
+  reorder_deadline_.reset();
+  if ( not peer_sacks_ or rack_end_ == 0 ) {
+    return;
+  }
+
+  // A quarter of the minimum RTT, but no more than SRTT, or none once recovery has begun. (RFC 8985 widens the
+  // window when it sees reordering; this sender doesn't look for it.)
+  const bool recovering = recovery_point_ or dup_acks_ >= DUP_ACK_THRESHOLD;
+  const uint64_t reorder_window
+    = recovering ? 0 : min( rtt_->min_rtt() / 4, static_cast<uint64_t>( rtt_->srtt() ) );
+
+  for ( Segment& seg : outstanding_ ) {
+    if ( scoreboard_.covers( seg.first, seg.end() ) ) {
+      continue;
+    }
+    if ( not sent_before_rack( seg ) ) {
+      if ( seg.resent ) {
+        continue; // a later segment may still have been sent earlier
+      }
+      break;
+    }
+    if ( seg.lost and not retransmitted_.contains( seg.first ) ) {
+      continue; // already waiting to be resent
+    }
+    const uint64_t deadline = seg.sent_ms + rack_rtt_ + reorder_window;
+    if ( deadline <= now_ms_ ) {
+      seg.lost = true;
+      retransmitted_.erase( seg.first ); // if this was a retransmission, it was lost too
+    } else {
+      reorder_deadline_ = max( reorder_deadline_.value_or( 0 ), deadline );
+    }
+  }
+
+  if ( fast_retransmit_ and not recovery_point_ and not outstanding_.empty() and is_lost( outstanding_.front() )
+       and outstanding_.front().first > recover_ ) {
+    enter_recovery();
+  }
+}
+
+uint64_t TCPSender::probe_timeout() const
+{
+  // RFC 8985 7.2: two SRTTs, and a lone segment's ACK may be delayed too (by as much as any peer might)
+  const auto pto = static_cast<uint64_t>( 2 * rtt_->srtt() );
+  return outstanding_.size() == 1 ? pto + TLP_MAX_ACK_DELAY_MS : pto;
+}
+
+bool TCPSender::probe_due() const
+{
+  // one probe per tail, and none during recovery or after the timer has expired
+  if ( not rack_ or not rtt_->has_samples() or tlp_ or recovery_point_ or consecutive_ret > 0
+       or window_size == 0 ) {
+    return false;
+  }
+  // but never later than the retransmission timer, which goes first if both are due (RFC 8985 7.2)
+  const uint64_t rto_deadline = now_ms_ - timer + RTO;
+  return now_ms_ >= min( probe_start_ms_ + probe_timeout(), rto_deadline );
+}
+
+void TCPSender::set_peer_window_scale( optional<uint8_t> shift )
+{
+  // RFC 7323: scaling is only in effect if both SYNs offered it, and shifts beyond 14 are treated as 14
+  peer_window_shift_ = ( window_scale_ and shift ) ? min( *shift, TCPConfig::MAX_WINDOW_SCALE ) : 0;
+}
+
+void TCPSender::set_peer_mss( optional<uint16_t> mss )
+{
+  const uint16_t peer_mss = max( mss.value_or( TCPConfig::DEFAULT_PEER_MSS ), TCPConfig::MIN_MSS );
+  mss_ = min<uint64_t>( mss_, peer_mss );
+  if ( cc_ ) {
+    cc_->set_mss( max_payload() );
+  }
+}
+
+void TCPSender::set_peer_timestamps( bool offered )
+{
+  peer_timestamps_ = timestamps_ and offered;
+  if ( peer_timestamps_ ) {
+    rtt_probe_.reset();
+  }
+  if ( cc_ ) {
+    cc_->set_mss( max_payload() ); // the window is counted in segments of the size actually sent
   }
 }
 
 void TCPSender::tick( uint64_t ms_since_last_tick, const TransmitFunction& transmit )
 {
   timer += ms_since_last_tick;
-  if ( !outstanding_msg.empty() ) {
+  now_ms_ += ms_since_last_tick;
+  if ( const double rate = pacing_rate(); rate > 0 ) {
+    // a coarse tick may bring a larger budget, but an idle sender can't save up more than a small burst
+    const double refill = rate * static_cast<double>( ms_since_last_tick );
+    pacing_budget_ = min( pacing_budget_ + refill, max( refill, static_cast<double>( PACING_BURST * mss_ ) ) );
+  }
+  if ( reorder_deadline_ and now_ms_ >= *reorder_deadline_ ) {
+    rack_detect_losses(); // the next push() resends what turned out to be lost
+  }
+  if ( !outstanding_.empty() ) {
     if ( timer >= RTO ) {
       if ( window_size != 0 ) {
+        // a real loss (not a zero-window probe): collapse cwnd, but only once per lost segment
+        if ( cc_ and consecutive_ret == 0 ) {
+          cc_->on_timeout( sequence_numbers_in_flight() );
+        }
         consecutive_ret++;
-        RTO = RTO * 2;
+        RTO = rtt_ ? min( RTO * 2, rtt_->max_RTO_ms() ) : RTO * 2;
       }
+      rtt_probe_.reset();
       timer = 0;
-      transmit( outstanding_msg.front() );
+
+      // a timeout ends any fast recovery, and dup ACKs for data sent before it don't start another
+      recovery_point_.reset();
+      recover_ = next_seqno_;
+      inflation_ = 0;
+      dup_acks_ = 0;
+      retransmit_pending_ = false;
+      retransmitted_.clear();
+      scoreboard_.clear(); // the receiver may have discarded what it SACKed (RFC 2018)
+      tlp_.reset();
+      reorder_deadline_.reset();
+      for ( Segment& seg : outstanding_ ) {
+        seg.lost = false;
+      }
+
+      transmit( resend( outstanding_.front() ) );
+    } else if ( probe_due() ) {
+      // a tail loss probe: resend the last segment, so that its ACK (or SACK) reveals any loss before the RTO
+      // (the retransmission timer keeps running, so the probe doesn't put off an RTO that is still needed)
+      tlp_ = TailProbe { next_seqno_, sequence_numbers_in_flight() };
+      rtt_probe_.reset();
+      transmit( resend( outstanding_.back() ) );
     }
   }
+  if ( cork_deadline_ and now_ms_ >= *cork_deadline_ ) {
+    push( transmit ); // the cork has held a partial segment for long enough
+  }
 }
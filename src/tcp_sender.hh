@@ -1,29 +1,55 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "rtt_estimator.hh"
+#include "sack_scoreboard.hh"
+#include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <list>
 #include <map>
 #include <memory>
 #include <optional>
-#include <queue>
+#include <set>
+#include <span>
+#include <vector>
 
 class TCPSender
 {
 public:
-  /* Construct TCP sender with given default Retransmission Timeout and possible ISN */
+  /* Construct TCP sender with given default Retransmission Timeout and possible ISN (no congestion control) */
   TCPSender( ByteStream&& input, Wrap32 isn, uint64_t initial_RTO_ms )
     : input_( std::move( input ) )
     , isn_( isn )
-    , seqno( isn )
     , initial_RTO_ms_( initial_RTO_ms )
     , RTO( initial_RTO_ms )
   {}
 
+  /* Construct TCP sender with the ISN, Retransmission Timeout bounds and congestion control given by `cfg`.
+     The RTO adapts to the measured round-trip time. */
+  TCPSender( ByteStream&& input, const TCPConfig& cfg )
+    : TCPSender( std::move( input ), cfg.isn, cfg.rt_timeout )
+  {
+    mss_ = cfg.mss;
+    mss_option_ = cfg.mss;
+    cc_ = make_congestion_controller( cfg.congestion_control, mss_ );
+    rtt_.emplace( cfg.rt_timeout, cfg.rt_timeout_min, cfg.rt_timeout_max );
+    fast_retransmit_ = cfg.fast_retransmit;
+    sack_ = cfg.sack;
+    window_scale_ = cfg.window_scale();
+    timestamps_ = cfg.timestamps;
+    pacing_ = cfg.pacing;
+    nagle_ = cfg.nagle;
+    rack_ = cfg.rack_tlp;
+    ecn_ = cfg.ecn;
+    pacing_budget_ = static_cast<double>( PACING_BURST * mss_ );
+  }
+
   /* Generate an empty TCPSenderMessage */
   TCPSenderMessage make_empty_message() const;
 
@@ -33,31 +59,190 @@ public:
   /* Type of the `transmit` function that the push and tick methods can use to send messages */
   using TransmitFunction = std::function<void( const TCPSenderMessage& )>;
 
-  /* Push bytes from the outbound stream */
+  /* Type of a `transmit` function that takes every segment from one push at once. The segments are only
+     valid during the call. */
+  using Batch = std::span<const TCPSenderMessage>;
+  using BatchTransmitFunction = std::function<void( Batch )>;
+
+  /* Push bytes from the outbound stream, filling the window, and hand the segments to `transmit` in one call */
+  void push( const BatchTransmitFunction& transmit );
+
+  /* Push bytes from the outbound stream, calling `transmit` once per segment */
   void push( const TransmitFunction& transmit );
 
   /* Time has passed by the given # of milliseconds since the last time the tick() method was called */
   void tick( uint64_t ms_since_last_tick, const TransmitFunction& transmit );
 
+  /* The peer's SYN arrived, offering `shift` as its window-scale shift count (nullopt: no window-scale option).
+     If our SYN offered scaling too, the windows in later TCPReceiverMessages are scaled up by it. */
+  void set_peer_window_scale( std::optional<uint8_t> shift );
+
+  /* The peer's SYN arrived with `mss` in its MSS option (nullopt: no option). Segments are cut to fit it. */
+  void set_peer_mss( std::optional<uint16_t> mss );
+
+  /* Hold back every segment smaller than the MSS (like TCP_CORK), until enough is written to fill one, the
+     sender is uncorked, or it has waited 200 ms. The next push() after uncorking sends what was held; tick()
+     sends it once the 200 ms are up. */
+  void set_cork( bool corked )
+  {
+    corked_ = corked;
+    cork_deadline_.reset();
+  }
+
+  /* Send small segments at once, even where Nagle's algorithm (TCPConfig::nagle) would hold them back
+     (like TCP_NODELAY). Corking still applies. */
+  void set_nodelay( bool nodelay ) { nodelay_ = nodelay; }
+
+  /* The peer's SYN arrived with (or without) the timestamps option. If our SYN carried it too, every segment
+     is stamped, and every ACK of new data gives an RTT sample, even after a retransmission. */
+  void set_peer_timestamps( bool offered );
+
+  /* The peer's SYN arrived offering ECN (or not). If our SYN offered it too, new data goes out ECN-capable, and
+     an ECE from the peer's receiver reduces the window as a loss would. (Before this, our SYN offers ECN if the
+     config says so; after, only if the peer's did.) */
+  void set_peer_ecn( bool offered ) { peer_ecn_ = ecn_ and offered; }
+
   // Accessors
   uint64_t sequence_numbers_in_flight() const;  // How many sequence numbers are outstanding?
   uint64_t consecutive_retransmissions() const; // How many consecutive *re*transmissions have happened?
+  uint64_t congestion_window() const;           // cwnd (UINT64_MAX without congestion control)
+  uint64_t slow_start_threshold() const;        // ssthresh (UINT64_MAX without congestion control)
+  uint64_t current_RTO_ms() const;              // Retransmission timeout, including any backoff
+  uint64_t mss() const { return mss_; }         // Maximum segment size, before subtracting TCP options
+  bool finished_sending() const;                // Has all of the closed outbound stream been sent at least once?
+  bool in_fast_recovery() const;                // Is a fast retransmit being recovered from?
+  double pacing_rate() const;                   // Bytes per ms new segments are paced at (0: not pacing)
+
+  // SRTT, RTTVAR etc. (nullopt if this sender has a fixed RTO)
+  const std::optional<RTTEstimator>& rtt() const { return rtt_; }
+
   Writer& writer() { return input_.writer(); }
   const Writer& writer() const { return input_.writer(); }
 
-  // Access input stream reader, but const-only (can't read from outside)
+  // Access input stream reader, but const-only (can't read from outside). Bytes are only popped once acknowledged.
   const Reader& reader() const { return input_.reader(); }
 
 private:
+  // An unacknowledged segment. Its payload stays in the outbound stream until it is acknowledged, so this is all
+  // it takes to send the segment again.
+  struct Segment
+  {
+    uint64_t first;  // absolute seqno
+    uint64_t length; // in sequence numbers, counting SYN and FIN
+    bool SYN;
+    bool FIN;
+    uint64_t sent_ms; // now_ms_ when it was last sent
+    bool resent;      // has it been sent more than once?
+    bool lost;        // deemed lost by RACK
+
+    uint64_t end() const { return first + length; }
+    uint64_t payload_size() const { return length - SYN - FIN; }
+  };
+
+  uint64_t effective_window( uint64_t in_network ) const; // min(cwnd, receiver's window), or 1 for a zero window
+  uint64_t base_RTO() const;                          // the RTO without backoff
+  void on_duplicate_ack();                            // count a duplicate ACK; the third starts a fast retransmit
+  void enter_recovery();                              // fast retransmit the first segment and start fast recovery
+  void record_sacks( const TCPReceiverMessage& msg ); // add msg's SACK blocks to the scoreboard
+  bool sack_recovery() const;                         // recovering by the scoreboard (RFC 6675), not NewReno?
+  bool is_lost( const Segment& seg ) const;           // has enough been SACKed above seg to deem it lost?
+  uint64_t pipe() const;                              // RFC 6675's estimate of the seqnos still in the network
+  void retransmit_holes( uint64_t& in_network );      // queue lost segments to resend while the pipe allows
+  uint64_t max_payload() const;                       // the MSS less the options on every segment (RFC 6691)
+  void stamp( TCPSenderMessage& msg ) const;          // set the timestamp of a segment about to be sent
+  TCPSenderMessage make_message( const Segment& seg ) const; // read back the payload, and stamp it
+  bool holds_back( const Segment& seg ) const; // should this small segment wait for more data (Nagle, cork)?
+  TCPSenderMessage resend( Segment& seg );           // note the retransmission time, and make the message
+  void rack_update( const Segment& seg );            // seg was delivered: is it the most recently sent one yet?
+  bool sent_before_rack( const Segment& seg ) const; // was a delivered segment sent after seg?
+  void rack_detect_losses();                         // mark segments lost by time; maybe start recovery
+  uint64_t probe_timeout() const;                    // when a tail loss probe goes out, after new data or ACK
+  bool probe_due() const;                            // should tick() send a tail loss probe now?
+
   // Variables initialized in constructor
   ByteStream input_;
   Wrap32 isn_;
-  Wrap32 seqno;
   uint64_t initial_RTO_ms_;
   uint64_t RTO;
-  uint64_t window_size = 1;
-  std::queue<TCPSenderMessage> outstanding_msg {};
+  uint64_t window_size = 1; // in sequence numbers, after scaling
+  uint64_t mss_ = TCPConfig::MAX_PAYLOAD_SIZE;
+  std::optional<uint16_t> mss_option_ {}; // what our SYN says our side can receive
+  std::deque<Segment> outstanding_ {};
+  uint64_t in_flight_ {};                  // the sum of the outstanding segments' lengths
+  uint64_t next_seqno_ {};                 // absolute seqno of the first sequence number never sent
+  uint64_t next_index_ {};                 // stream index of the first byte never sent
+  std::vector<TCPSenderMessage> batch_ {}; // what this push() sends, in order
   uint64_t consecutive_ret {};
   uint64_t timer {};
   bool FIN_SENT = false;
+  std::unique_ptr<CongestionController> cc_ {}; // null: limited only by the receiver's window
+  uint64_t now_ms_ {};                          // total time passed to tick()
+
+  // One segment at a time is timed; the sample is discarded if anything is retransmitted meanwhile (Karn)
+  struct RTTProbe
+  {
+    uint64_t end;     // absolute seqno just past the timed segment
+    uint64_t sent_ms; // now_ms_ when it was sent
+  };
+  std::optional<RTTEstimator> rtt_ {}; // nullopt: the RTO stays at initial_RTO_ms_ (doubling on timeouts)
+  std::optional<RTTProbe> rtt_probe_ {};
+
+  // Fast retransmit and NewReno fast recovery
+  static constexpr uint64_t DUP_ACK_THRESHOLD = 3;
+  bool fast_retransmit_ {};
+  uint64_t dup_acks_ {};                      // duplicate ACKs since the last one that acknowledged data
+  std::optional<uint64_t> recovery_point_ {}; // while recovering: absolute seqno sent before the loss
+  uint64_t recover_ {};                       // no new recovery until the ackno passes this (RFC 6582)
+  uint64_t inflation_ {};                     // bytes added to cwnd for segments the dup ACKs say have left
+  bool retransmit_pending_ {};                // the next push() starts by resending the first segment
+
+  // Selective acknowledgments: offered on the SYN, and once the peer has sent some, recovery follows them
+  bool sack_ {};
+  bool peer_sacks_ {};
+  SACKScoreboard scoreboard_ {};
+  std::set<uint64_t> retransmitted_ {}; // absolute seqnos of segments resent during this recovery
+
+  // Window scaling (RFC 7323)
+  std::optional<uint8_t> window_scale_ {}; // the shift count our SYN offers the peer's sender
+  uint8_t peer_window_shift_ {};           // the peer receiver's windows are in units of 2^this
+
+  // Timestamps (RFC 7323): offered on the SYN, and in use on all segments once the peer's SYN had them too
+  bool timestamps_ {};
+  bool peer_timestamps_ {};
+
+  // Pacing: once the RTT is known, new segments spend a budget of bytes that tick() refills at pacing_rate()
+  static constexpr double PACING_SS_GAIN = 2.0;  // rate = gain * cwnd / SRTT, doubling cwnd each RTT in slow start
+  static constexpr double PACING_CA_GAIN = 1.2;  // and a little above cwnd / SRTT in congestion avoidance
+  static constexpr uint64_t PACING_BURST = 2;    // segments the budget may save up beyond one tick's worth
+  bool pacing_ {};
+  double pacing_budget_ {}; // bytes; a segment may go out while positive (so it may end up overdrawn)
+
+  // Coalescing small writes
+  static constexpr uint64_t CORK_TIMEOUT_MS = 200; // the longest the cork holds a partial segment, as in Linux
+  bool nagle_ {};
+  bool nodelay_ {};
+  bool corked_ {};
+  std::optional<uint64_t> cork_deadline_ {}; // while the cork holds a partial segment: when it must go out
+
+  // RACK-TLP (RFC 8985): of the segments delivered (acknowledged or SACKed), the one sent most recently tells
+  // which earlier ones should have arrived by now; and a probe asks about an unacknowledged tail
+  struct TailProbe
+  {
+    uint64_t end;       // absolute seqno just past what was sent when the probe went out
+    uint64_t in_flight; // sequence_numbers_in_flight() then
+  };
+  static constexpr uint64_t TLP_MAX_ACK_DELAY_MS = 200; // WCDelAckT: how long a lone segment's ACK may be delayed
+  bool rack_ {};
+  uint64_t rack_sent_ms_ {};                    // when the most recently sent delivered segment was sent
+  uint64_t rack_end_ {};                        // and its end (0: nothing delivered yet)
+  uint64_t rack_rtt_ {};                        // and its round-trip time
+  std::optional<uint64_t> reorder_deadline_ {}; // when a segment still within the reordering window is lost
+  uint64_t probe_start_ms_ {};                  // the latest new data sent or ACK of new data
+  std::optional<TailProbe> tlp_ {};             // an unanswered tail loss probe
+
+  // Explicit Congestion Notification (RFC 3168)
+  bool ecn_ {};
+  std::optional<bool> peer_ecn_ {}; // is ECN in use? (nullopt until the peer's SYN arrives)
+  uint64_t ecn_recover_ {};         // ECE is ignored until the ackno passes this: one response per window
+  bool cwr_pending_ {};             // the next new segment tells the receiver that its ECE was answered
 };
@@ -0,0 +1,111 @@
+#include "broadcast_stream.hh"
+#include "broadcast_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      BroadcastStreamTestHarness test { "every reader sees every byte", 15 };
+
+      test.execute( AddReader { 15, 0 } );
+      test.execute( AddReader { 15, 1 } );
+      test.execute( Push { "cat" } );
+      test.execute( BytesPushed { 3 } );
+      test.execute( Peek { 0, "cat" } );
+      test.execute( Peek { 1, "cat" } );
+      test.execute( Pop { 0, 3 } );
+      test.execute( BytesBuffered { 0, 0 } );
+      test.execute( BytesBuffered { 1, 3 } );
+      test.execute( PeekOnce { 1, "cat" } );
+      test.execute( Push { "tac" } );
+      test.execute( Peek { 0, "tac" } );
+      test.execute( Peek { 1, "cattac" } );
+    }
+
+    {
+      BroadcastStreamTestHarness test { "capacity is limited by the slowest reader", 8 };
+
+      test.execute( AddReader { 8, 0 } );
+      test.execute( AddReader { 8, 1 } );
+      test.execute( Push { "abcdef" } );
+      test.execute( Pop { 0, 6 } );
+      test.execute( AvailableCapacity { 2 } );
+      test.execute( Pop { 1, 2 } );
+      test.execute( AvailableCapacity { 4 } );
+      test.execute( Push { "ghij" } );
+      test.execute( BytesPushed { 10 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Peek { 0, "ghij" } );
+      test.execute( Peek { 1, "cdefghij" } );
+    }
+
+    {
+      BroadcastStreamTestHarness test { "a new reader starts at the end", 10 };
+
+      test.execute( AddReader { 10, 0 } );
+      test.execute( Push { "hello" } );
+      test.execute( AddReader { 10, 1 } );
+      test.execute( BytesBuffered { 1, 0 } );
+      test.execute( Push { "world" } );
+      test.execute( Peek { 0, "helloworld" } );
+      test.execute( Peek { 1, "world" } );
+      test.execute( Pop { 1, 5 } );
+      test.execute( BytesPopped { 1, 5 } );
+      test.execute( BytesPopped { 0, 0 } );
+    }
+
+    {
+      BroadcastStreamTestHarness test { "with no readers, pushes are discarded", 4 };
+
+      test.execute( Push { "abcdef" } );
+      test.execute( BytesPushed { 4 } );
+      test.execute( AvailableCapacity { 4 } );
+      test.execute( Push { "gh" } );
+      test.execute( BytesPushed { 6 } );
+      test.execute( ReaderCount { 0 } );
+    }
+
+    {
+      BroadcastStreamTestHarness test { "removing the slowest reader reclaims its space", 6 };
+
+      test.execute( AddReader { 6, 0 } );
+      test.execute( AddReader { 6, 1 } );
+      test.execute( Push { "abcdef" } );
+      test.execute( Pop { 0, 4 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( RemoveReader { 1 } );
+      test.execute( ReaderCount { 1 } );
+      test.execute( AvailableCapacity { 4 } );
+      test.execute( AddReader { 6, 1 } ); // the removed id is reused
+      test.execute( Push { "gh" } );
+      test.execute( Peek { 0, "efgh" } );
+      test.execute( Peek { 1, "gh" } );
+    }
+
+    {
+      BroadcastStreamTestHarness test { "each reader finishes on its own", 10 };
+
+      test.execute( AddReader { 10, 0 } );
+      test.execute( AddReader { 10, 1 } );
+      test.execute( Push { "bye" } );
+      test.execute( Close {} );
+      test.execute( IsClosed { true } );
+      test.execute( IsFinished { 0, false } );
+      test.execute( Pop { 0, 3 } );
+      test.execute( IsFinished { 0, true } );
+      test.execute( IsFinished { 1, false } );
+      test.execute( Pop { 1, 3 } );
+      test.execute( IsFinished { 1, true } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
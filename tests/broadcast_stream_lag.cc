@@ -0,0 +1,127 @@
+#include "broadcast_stream.hh"
+#include "broadcast_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      BroadcastStreamTestHarness test { "a reader within its lag limit is kept", 16 };
+
+      test.execute( AddReader { 16, 0 } );
+      test.execute( AddReader { 6, 1 } );
+      test.execute( Push { "abcdef" } );
+      test.execute( IsEvicted { 1, false } );
+      test.execute( ReaderCount { 2 } );
+      test.execute( Peek { 1, "abcdef" } );
+    }
+
+    {
+      BroadcastStreamTestHarness test { "a slow reader is evicted and its space reclaimed", 8 };
+
+      test.execute( AddReader { 8, 0 } );
+      test.execute( AddReader { 4, 1 } );
+      test.execute( Push { "abcd" } );
+      test.execute( Pop { 0, 4 } );
+      test.execute( AvailableCapacity { 4 } );
+      test.execute( Push { "efgh" } ); // would leave reader 1 eight bytes behind
+      test.execute( IsEvicted { 1, true } );
+      test.execute( ReaderCount { 1 } );
+      test.execute( BytesBuffered { 1, 0 } );
+      test.execute( BytesPushed { 8 } );
+      test.execute( AvailableCapacity { 4 } );
+      test.execute( Peek { 0, "efgh" } );
+    }
+
+    {
+      BroadcastStreamTestHarness test { "evicting a reader makes room for the whole push", 8 };
+
+      test.execute( AddReader { 8, 0 } );
+      test.execute( AddReader { 4, 1 } );
+      test.execute( Push { "abc" } );
+      test.execute( Pop { 0, 3 } );
+      test.execute( Push { "defghijk" } ); // only five bytes fit while reader 1 is still three behind
+      test.execute( IsEvicted { 1, true } );
+      test.execute( BytesPushed { 11 } );
+      test.execute( Peek { 0, "defghijk" } );
+    }
+
+    {
+      BroadcastStreamTestHarness test { "an evicted reader never finishes", 8 };
+
+      test.execute( AddReader { 2, 0 } );
+      test.execute( Push { "ab" } );
+      test.execute( Push { "c" } );
+      test.execute( IsEvicted { 0, true } );
+      test.execute( Close {} );
+      test.execute( IsFinished { 0, false } );
+      test.execute( RemoveReader { 0 } );
+      test.execute( ReaderCount { 0 } );
+    }
+
+    {
+      BroadcastStreamTestHarness test { "only the readers that fall behind are evicted", 12 };
+
+      test.execute( AddReader { 12, 0 } );
+      test.execute( AddReader { 5, 1 } );
+      test.execute( AddReader { 5, 2 } );
+      test.execute( Push { "abc" } );
+      test.execute( Pop { 1, 3 } );
+      test.execute( Push { "def" } );
+      test.execute( IsEvicted { 1, false } );
+      test.execute( IsEvicted { 2, true } );
+      test.execute( Peek { 0, "abcdef" } );
+      test.execute( Peek { 1, "def" } );
+    }
+
+    {
+      BroadcastStreamTestHarness test { "a push is cut to the lag limit, not held against a caught-up reader", 16 };
+
+      test.execute( AddReader { 16, 0 } );
+      test.execute( AddReader { 4, 1 } );
+      test.execute( Push { "abcdefgh" } );
+      test.execute( IsEvicted { 1, false } );
+      test.execute( BytesPushed { 4 } );
+      test.execute( Peek { 1, "abcd" } );
+      test.execute( Pop { 1, 4 } );
+      test.execute( Push { "efgh" } ); // the rest, once reader 1 has caught up
+      test.execute( IsEvicted { 1, false } );
+      test.execute( Peek { 0, "abcdefgh" } );
+      test.execute( Peek { 1, "efgh" } );
+    }
+
+    {
+      BroadcastStreamTestHarness test { "a reader with a backlog is still evicted", 16 };
+
+      test.execute( AddReader { 16, 0 } );
+      test.execute( AddReader { 4, 1 } );
+      test.execute( Push { "ab" } );
+      test.execute( Push { "cdefgh" } ); // cut to four bytes, which would leave reader 1 six behind
+      test.execute( IsEvicted { 1, true } );
+      test.execute( BytesPushed { 8 } ); // and with reader 1 gone, the rest fits too
+      test.execute( Peek { 0, "abcdefgh" } );
+    }
+
+    {
+      bool threw = false;
+      try {
+        BroadcastStream { 8 }.add_reader( 0 );
+      } catch ( const runtime_error& ) {
+        threw = true;
+      }
+      if ( not threw ) {
+        throw runtime_error( "a reader with no lag limit at all should be rejected" );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
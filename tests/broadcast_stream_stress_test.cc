@@ -0,0 +1,102 @@
+#include "broadcast_stream_test_harness.hh"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+void stress_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
+                  const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                  const size_t num_readers, // NOLINT(bugprone-easily-swappable-parameters)
+                  const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+
+  const string data = [&rd, &input_len] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < input_len; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  BroadcastStreamTestHarness bs { "stress test input=" + to_string( input_len ) + ", capacity="
+                                    + to_string( capacity ) + ", readers=" + to_string( num_readers ),
+                                  capacity };
+
+  // a lag limit of `capacity` is never exceeded, so no reader is evicted
+  for ( size_t id = 0; id < num_readers; ++id ) {
+    bs.execute( AddReader { capacity, id } );
+  }
+
+  size_t expected_bytes_pushed {};
+  vector<size_t> expected_bytes_popped( num_readers );
+  const auto slowest = [&] { return *ranges::min_element( expected_bytes_popped ); };
+
+  while ( slowest() < data.size() ) {
+    bs.execute( BytesPushed { expected_bytes_pushed } );
+    bs.execute( AvailableCapacity { capacity - ( expected_bytes_pushed - slowest() ) } );
+
+    /* write something */
+    uniform_int_distribution<size_t> bytes_to_push_dist { 0, data.size() - expected_bytes_pushed };
+    const size_t amount_to_push = bytes_to_push_dist( rd );
+    bs.execute( Push { data.substr( expected_bytes_pushed, amount_to_push ) } );
+    expected_bytes_pushed += min( amount_to_push, capacity - ( expected_bytes_pushed - slowest() ) );
+    bs.execute( BytesPushed { expected_bytes_pushed } );
+
+    if ( expected_bytes_pushed == data.size() ) {
+      bs.execute( Close {} );
+    }
+
+    /* each reader reads something */
+    for ( size_t id = 0; id < num_readers; ++id ) {
+      const size_t popped = expected_bytes_popped[id];
+      bs.execute( BytesBuffered { id, expected_bytes_pushed - popped } );
+
+      const size_t peek_size = bs.peek_size( id );
+      if ( ( expected_bytes_pushed != popped ) and peek_size == 0 ) {
+        throw runtime_error( "BroadcastReader::peek() returned empty view" );
+      }
+      if ( popped + peek_size > expected_bytes_pushed ) {
+        throw runtime_error( "BroadcastReader::peek() returned too-large view" );
+      }
+
+      bs.execute( PeekOnce { id, data.substr( popped, peek_size ) } );
+      bs.execute( Peek { id, data.substr( popped, expected_bytes_pushed - popped ) } );
+
+      uniform_int_distribution<size_t> bytes_to_pop_dist { 0, peek_size };
+      const size_t amount_to_pop = bytes_to_pop_dist( rd );
+      bs.execute( Pop { id, amount_to_pop } );
+      expected_bytes_popped[id] += amount_to_pop;
+      bs.execute( BytesPopped { id, expected_bytes_popped[id] } );
+    }
+  }
+
+  for ( size_t id = 0; id < num_readers; ++id ) {
+    bs.execute( IsFinished { id, true } );
+    bs.execute( IsEvicted { id, false } );
+  }
+}
+
+void program_body()
+{
+  stress_test( 19, 3, 1, 10110 );
+  stress_test( 18, 17, 3, 12345 );
+  stress_test( 1111, 17, 4, 98765 );
+  stress_test( 4097, 4096, 8, 11101 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
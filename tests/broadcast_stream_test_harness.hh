@@ -0,0 +1,206 @@
+#pragma once
+
+#include "broadcast_stream.hh"
+#include "common.hh"
+
+#include <utility>
+
+static_assert( sizeof( BroadcastWriter ) == sizeof( BroadcastStream ),
+               "Please add member variables to the BroadcastStream base, not the BroadcastWriter." );
+
+class BroadcastStreamTestHarness : public TestHarness<BroadcastStream>
+{
+public:
+  BroadcastStreamTestHarness( std::string test_name, uint64_t capacity )
+    : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), BroadcastStream { capacity } )
+  {}
+
+  size_t peek_size( size_t id ) { return BroadcastStream { object() }.reader( id ).peek().size(); }
+};
+
+/* actions */
+
+struct Push : public Action<BroadcastStream>
+{
+  std::string data_;
+
+  explicit Push( std::string data ) : data_( move( data ) ) {}
+  std::string description() const override { return "push \"" + Printer::prettify( data_ ) + "\" to the stream"; }
+  void execute( BroadcastStream& bs ) const override { bs.writer().push( data_ ); }
+};
+
+struct Close : public Action<BroadcastStream>
+{
+  std::string description() const override { return "close"; }
+  void execute( BroadcastStream& bs ) const override { bs.writer().close(); }
+};
+
+struct AddReader : public Action<BroadcastStream>
+{
+  uint64_t max_lag_;
+  size_t id_;
+
+  AddReader( uint64_t max_lag, size_t id ) : max_lag_( max_lag ), id_( id ) {}
+  std::string description() const override
+  {
+    return "add reader " + std::to_string( id_ ) + " with max_lag=" + std::to_string( max_lag_ );
+  }
+  void execute( BroadcastStream& bs ) const override
+  {
+    const size_t id = bs.add_reader( max_lag_ );
+    if ( id != id_ ) {
+      throw ExpectationViolation { "reader id", id_, id };
+    }
+  }
+};
+
+struct RemoveReader : public Action<BroadcastStream>
+{
+  size_t id_;
+
+  explicit RemoveReader( size_t id ) : id_( id ) {}
+  std::string description() const override { return "remove reader " + std::to_string( id_ ); }
+  void execute( BroadcastStream& bs ) const override { bs.remove_reader( id_ ); }
+};
+
+struct Pop : public Action<BroadcastStream>
+{
+  size_t id_;
+  size_t len_;
+
+  Pop( size_t id, size_t len ) : id_( id ), len_( len ) {}
+  std::string description() const override
+  {
+    return "reader " + std::to_string( id_ ) + " pop( " + std::to_string( len_ ) + " )";
+  }
+  void execute( BroadcastStream& bs ) const override { bs.reader( id_ ).pop( len_ ); }
+};
+
+/* expectations */
+
+struct Peek : public Expectation<BroadcastStream>
+{
+  size_t id_;
+  std::string output_;
+
+  Peek( size_t id, std::string output ) : id_( id ), output_( move( output ) ) {}
+
+  std::string description() const override
+  {
+    return "reader " + std::to_string( id_ ) + " peeking produces \"" + Printer::prettify( output_ ) + "\"";
+  }
+
+  void execute( BroadcastStream& bs ) const override
+  {
+    BroadcastStream copy = bs;
+    auto reader = copy.reader( id_ );
+    std::string got;
+
+    while ( reader.bytes_buffered() ) {
+      auto peeked = reader.peek();
+      if ( peeked.empty() ) {
+        throw ExpectationViolation { "BroadcastReader::peek() returned empty string_view" };
+      }
+      got += peeked;
+      reader.pop( peeked.size() );
+    }
+
+    if ( got != output_ ) {
+      throw ExpectationViolation { "Expected \"" + Printer::prettify( output_ ) + "\" for reader "
+                                   + std::to_string( id_ ) + ", but found \"" + Printer::prettify( got ) + "\"" };
+    }
+  }
+};
+
+struct PeekOnce : public Peek
+{
+  using Peek::Peek;
+
+  std::string description() const override
+  {
+    return "reader " + std::to_string( id_ ) + " peek() gives exactly \"" + Printer::prettify( output_ ) + "\"";
+  }
+
+  void execute( BroadcastStream& bs ) const override
+  {
+    auto peeked = bs.reader( id_ ).peek();
+    if ( peeked != output_ ) {
+      throw ExpectationViolation { "Expected exactly \"" + Printer::prettify( output_ ) + "\" at front of reader "
+                                   + std::to_string( id_ ) + ", but found \"" + Printer::prettify( peeked )
+                                   + "\"" };
+    }
+  }
+};
+
+template<typename Num>
+struct ReaderExpectNumber : public ExpectNumber<BroadcastStream, Num>
+{
+  size_t id_;
+
+  ReaderExpectNumber( size_t id, Num value ) : ExpectNumber<BroadcastStream, Num>( value ), id_( id ) {}
+  std::string name() const override { return "reader " + std::to_string( id_ ) + " " + property(); }
+  Num value( BroadcastStream& bs ) const override { return value( bs.reader( id_ ) ); }
+
+  virtual std::string property() const = 0;
+  virtual Num value( const BroadcastReader& reader ) const = 0;
+};
+
+struct IsFinished : public ReaderExpectNumber<bool>
+{
+  using ReaderExpectNumber::ReaderExpectNumber;
+  using ReaderExpectNumber::value;
+  std::string property() const override { return "is_finished"; }
+  bool value( const BroadcastReader& reader ) const override { return reader.is_finished(); }
+};
+
+struct IsEvicted : public ReaderExpectNumber<bool>
+{
+  using ReaderExpectNumber::ReaderExpectNumber;
+  using ReaderExpectNumber::value;
+  std::string property() const override { return "is_evicted"; }
+  bool value( const BroadcastReader& reader ) const override { return reader.is_evicted(); }
+};
+
+struct BytesBuffered : public ReaderExpectNumber<uint64_t>
+{
+  using ReaderExpectNumber::ReaderExpectNumber;
+  using ReaderExpectNumber::value;
+  std::string property() const override { return "bytes_buffered"; }
+  uint64_t value( const BroadcastReader& reader ) const override { return reader.bytes_buffered(); }
+};
+
+struct BytesPopped : public ReaderExpectNumber<uint64_t>
+{
+  using ReaderExpectNumber::ReaderExpectNumber;
+  using ReaderExpectNumber::value;
+  std::string property() const override { return "bytes_popped"; }
+  uint64_t value( const BroadcastReader& reader ) const override { return reader.bytes_popped(); }
+};
+
+struct ReaderCount : public ExpectNumber<BroadcastStream, size_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "reader_count"; }
+  size_t value( BroadcastStream& bs ) const override { return bs.reader_count(); }
+};
+
+struct AvailableCapacity : public ExpectNumber<BroadcastStream, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "available_capacity"; }
+  uint64_t value( BroadcastStream& bs ) const override { return bs.writer().available_capacity(); }
+};
+
+struct BytesPushed : public ExpectNumber<BroadcastStream, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "bytes_pushed"; }
+  uint64_t value( BroadcastStream& bs ) const override { return bs.writer().bytes_pushed(); }
+};
+
+struct IsClosed : public ExpectBool<BroadcastStream>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "is_closed"; }
+  bool value( BroadcastStream& bs ) const override { return bs.writer().is_closed(); }
+};
@@ -0,0 +1,96 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "chunks: peek gives the oldest pushed string", 15, ByteStream::Mode::Chunks };
+
+      test.execute( Push { "cat" } );
+      test.execute( Push { "tac" } );
+      test.execute( BytesPushed { 6 } );
+      test.execute( BytesBuffered { 6 } );
+      test.execute( AvailableCapacity { 9 } );
+      test.execute( PeekOnce { "cat" } );
+      test.execute( PeekAll { "cattac" }.with_regions( 2 ) );
+      test.execute( PeekAt { 2, 3, "tta" } );
+      test.execute( PeekAt { 4, 10, "ac" } );
+      test.execute( PeekAt { 6, 1, "" } );
+      test.execute( Peek { "cattac" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "chunks: partial pop moves into the front chunk", 15, ByteStream::Mode::Chunks };
+
+      test.execute( Push { "hello" } );
+      test.execute( Push { "world" } );
+      test.execute( Pop { 2 } );
+      test.execute( PeekOnce { "llo" } );
+      test.execute( BytesPopped { 2 } );
+      test.execute( Pop { 3 } );
+      test.execute( PeekOnce { "world" } );
+      test.execute( Pop { 4 } );
+      test.execute( PeekOnce { "d" } );
+      test.execute( BytesBuffered { 1 } );
+      test.execute( AvailableCapacity { 14 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "chunks: pop across several chunks", 15, ByteStream::Mode::Chunks };
+
+      test.execute( Push { "a" } );
+      test.execute( Push { "bc" } );
+      test.execute( Push { "def" } );
+      test.execute( Pop { 4 } );
+      test.execute( PeekOnce { "ef" } );
+      test.execute( PeekAll { "ef" }.with_regions( 1 ) );
+      test.execute( Push { "g" } );
+      test.execute( PeekAt { 1, 2, "fg" } );
+      test.execute( Peek { "efg" } );
+      test.execute( Close {} );
+      test.execute( ReadAll { "efg" } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ByteStreamTestHarness test { "chunks: pushes are trimmed to capacity", 5, ByteStream::Mode::Chunks };
+
+      test.execute( Push { "abc" } );
+      test.execute( Push { "defgh" } );
+      test.execute( BytesPushed { 5 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Push { "ijk" } );
+      test.execute( BytesPushed { 5 } );
+      test.execute( Peek { "abcde" } );
+      test.execute( Pop { 4 } );
+      test.execute( PeekOnce { "e" } );
+      test.execute( Push { "lmnopq" } );
+      test.execute( BytesPushed { 9 } );
+      test.execute( Peek { "elmno" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "chunks: pop of everything buffered", 8, ByteStream::Mode::Chunks };
+
+      test.execute( Push { "abcd" } );
+      test.execute( Push { "efgh" } );
+      test.execute( Pop { 100 } );
+      test.execute( BufferEmpty { true } );
+      test.execute( BytesPopped { 8 } );
+      test.execute( AvailableCapacity { 8 } );
+      test.execute( Push { "ijkl" } );
+      test.execute( PeekOnce { "ijkl" } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,72 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    // 4096 bytes is one page, so the ring is exactly the stream's capacity
+    const string first( 4000, 'x' );
+
+    {
+      ByteStreamTestHarness test {
+        "mirrored: peek is contiguous across the wrap", 4096, ByteStream::Mode::Mirrored };
+
+      test.execute( Push { first } );
+      test.execute( Pop { 4000 } );
+      test.execute( Push { string( 96, 'a' ) + string( 104, 'b' ) } );
+      test.execute( BytesBuffered { 200 } );
+      test.execute( PeekOnce { string( 96, 'a' ) + string( 104, 'b' ) } );
+      test.execute( PeekAll { string( 96, 'a' ) + string( 104, 'b' ) }.with_regions( 1 ) );
+      test.execute( Pop { 150 } );
+      test.execute( PeekOnce { string( 50, 'b' ) } );
+    }
+
+    {
+      ByteStreamTestHarness test {
+        "mirrored: reserve is contiguous across the wrap", 4096, ByteStream::Mode::Mirrored };
+
+      test.execute( Push { first } );
+      test.execute( Pop { 4000 } );
+      test.execute( ReserveAndCommit { string( 300, 'c' ) } );
+      test.execute( BytesPushed { 4300 } );
+      test.execute( PeekOnce { string( 300, 'c' ) } );
+    }
+
+    {
+      ByteStreamTestHarness test { "mirrored: a full stream peeks whole", 4096, ByteStream::Mode::Mirrored };
+
+      test.execute( Push { first } );
+      test.execute( Pop { 4000 } );
+      test.execute( Push { string( 4096, 'd' ) } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( PeekOnce { string( 4096, 'd' ) } );
+    }
+
+    {
+      // the ring is rounded up to a page, but the stream still holds only `capacity` bytes
+      ByteStreamTestHarness test { "mirrored: capacity is not rounded up", 5, ByteStream::Mode::Mirrored };
+
+      test.execute( Push { "abcdefgh" } );
+      test.execute( BytesPushed { 5 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( PeekOnce { "abcde" } );
+      test.execute( Pop { 3 } );
+      test.execute( Push { "ijk" } );
+      test.execute( PeekOnce { "deijk" } );
+      test.execute( Close {} );
+      test.execute( ReadAll { "deijk" } );
+      test.execute( IsFinished { true } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    for ( const auto mode : { ByteStream::Mode::Ring, ByteStream::Mode::Chunks, ByteStream::Mode::Mirrored } ) {
+      {
+        ByteStreamTestHarness test { "reserve and commit", 15, mode };
+
+        test.execute( ReserveAndCommit { "cat" } );
+        test.execute( BytesPushed { 3 } );
+        test.execute( BytesBuffered { 3 } );
+        test.execute( AvailableCapacity { 12 } );
+        test.execute( Peek { "cat" } );
+        test.execute( ReserveAndCommit { "tac" } );
+        test.execute( Peek { "cattac" } );
+        test.execute( Close {} );
+        test.execute( ReadAll { "cattac" } );
+        test.execute( IsFinished { true } );
+      }
+
+      {
+        ByteStreamTestHarness test { "reserve is limited by capacity", 5, mode };
+
+        test.execute( Push { "ab" } );
+        test.execute( ReserveAndCommit { "cdefg" } );
+        test.execute( BytesPushed { 5 } );
+        test.execute( AvailableCapacity { 0 } );
+        test.execute( ReserveAndCommit { "h" } );
+        test.execute( BytesPushed { 5 } );
+        test.execute( Peek { "abcde" } );
+      }
+
+      {
+        ByteStreamTestHarness test { "reserve and push interleave", 8, mode };
+
+        test.execute( ReserveAndCommit { "ab" } );
+        test.execute( Push { "cd" } );
+        test.execute( ReserveAndCommit { "ef" } );
+        test.execute( Pop { 3 } );
+        test.execute( Push { "gh" } );
+        test.execute( ReserveAndCommit { "ijkl" } );
+        test.execute( BytesPushed { 11 } );
+        test.execute( Peek { "defghijk" } );
+      }
+    }
+
+    {
+      ByteStreamTestHarness test { "reserve stops at the end of the ring", 5 };
+
+      test.execute( Push { "abc" } );
+      test.execute( Pop { 3 } );
+      test.execute( ReserveAndCommit { "defgh" } ); // only two bytes remain before the ring wraps
+      test.execute( BytesPushed { 5 } );
+      test.execute( PeekOnce { "de" } );
+      test.execute( PeekAll { "de" }.with_regions( 1 ) );
+      test.execute( ReserveAndCommit { "fgh" } ); // now continues from the start of the storage
+      test.execute( BytesPushed { 8 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( PeekAll { "defgh" }.with_regions( 2 ) );
+      test.execute( Peek { "defgh" } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
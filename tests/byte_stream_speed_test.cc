@@ -15,7 +15,8 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
                  const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t write_size,  // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t read_size )  // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t read_size,   // NOLINT(bugprone-easily-swappable-parameters)
+                 const ByteStream::Mode mode = ByteStream::Mode::Ring )
 {
   // Generate the data to be written
   const string data = [&random_seed, &input_len] {
@@ -34,7 +35,7 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
     split_data.emplace( data.substr( i, write_size ) );
   }
 
-  ByteStream bs { capacity };
+  ByteStream bs { capacity, mode };
   string output_data;
   output_data.reserve( data.size() );
 
@@ -75,8 +76,12 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
   fstream debug_output;
   debug_output.open( "/dev/tty" );
 
-  cout << "ByteStream with capacity=" << capacity << ", write_size=" << write_size << ", read_size=" << read_size
-       << " reached " << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
+  const string_view mode_name = mode == ByteStream::Mode::Chunks     ? "Chunked "
+                                : mode == ByteStream::Mode::Mirrored ? "Mirrored "
+                                                                     : "";
+  cout << mode_name << "ByteStream with capacity=" << capacity
+       << ", write_size=" << write_size << ", read_size=" << read_size << " reached " << fixed
+       << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
 
   debug_output << "             ByteStream throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
                << " Gbit/s\n";
@@ -89,6 +94,14 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
 void program_body()
 {
   speed_test( 1e7, 32768, 789, 1500, 128 );
+  speed_test( 1e7, 64000, 789, 1500, 1000 ); // drain a TCPConfig::DEFAULT_CAPACITY stream in segment-sized reads
+  speed_test( 1e7, 64000, 789, 1500, 16 );   // many small reads from a mostly-full buffer
+  speed_test( 1e7, 64000, 789, 1500, 1000, ByteStream::Mode::Chunks );
+  speed_test( 1e7, 1048576, 789, 65536, 65536, ByteStream::Mode::Ring );
+  speed_test( 1e7, 1048576, 789, 65536, 65536, ByteStream::Mode::Chunks ); // large pushes are kept, not copied
+  speed_test( 1e7, 1048576, 789, 65536, 65536, ByteStream::Mode::Mirrored );
+  speed_test( 1e7, 1048576, 789, 1500, 16384, ByteStream::Mode::Ring ); // reads that often straddle the wrap
+  speed_test( 1e7, 1048576, 789, 1500, 16384, ByteStream::Mode::Mirrored );
 }
 
 int main()
@@ -0,0 +1,197 @@
+#include "spsc_byte_stream.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace std;
+
+void expect( const string& what, bool condition )
+{
+  if ( not condition ) {
+    throw runtime_error( "expected " + what );
+  }
+}
+
+void reserve_and_commit( SPSCWriter& writer, string_view data )
+{
+  const auto space = writer.reserve( data.size() );
+  data.copy( space.data(), space.size() );
+  writer.commit( space.size() );
+}
+
+string peek_all( const SPSCReader& reader )
+{
+  string ret;
+  for ( const auto region : reader.peek_all() ) {
+    ret += region;
+  }
+  return ret;
+}
+
+int main()
+{
+  try {
+    /* reserve() stops at the end of the ring, and the next reserve() continues from the start */
+    {
+      SPSCByteStream bs { 5 };
+
+      bs.writer().push( "abc" );
+      bs.reader().pop( 3 );
+      reserve_and_commit( bs.writer(), "defgh" ); // only two bytes remain before the ring wraps
+      expect( "two bytes committed", bs.writer().bytes_pushed() == 5 );
+      expect( "one region", bs.reader().peek() == "de" and bs.reader().peek_all().size() == 1 );
+
+      reserve_and_commit( bs.writer(), "fgh" );
+      expect( "three more bytes committed", bs.writer().bytes_pushed() == 8 );
+      expect( "no capacity left", bs.writer().available_capacity() == 0 );
+      expect( "an empty reservation", bs.writer().reserve( 1 ).empty() );
+      expect( "two regions", bs.reader().peek_all().size() == 2 and peek_all( bs.reader() ) == "defgh" );
+      expect( "peek() to stop at the end of the ring", bs.reader().peek() == "de" );
+
+      bs.reader().pop( 4 );
+      expect( "a push that wraps in one call", bs.writer().push( "ijkl" ) == 4 );
+      expect( "the wrapped bytes", peek_all( bs.reader() ) == "hijkl" );
+    }
+
+    /* commit() of more than was reserved is an error */
+    {
+      SPSCByteStream bs { 4 };
+
+      const auto space = bs.writer().reserve( 8 );
+      expect( "a reservation limited by capacity", space.size() == 4 );
+      bool threw = false;
+      try {
+        bs.writer().commit( 5 );
+      } catch ( const runtime_error& ) {
+        threw = true;
+      }
+      expect( "commit() past the reservation to throw", threw );
+      expect( "nothing pushed", bs.writer().bytes_pushed() == 0 );
+    }
+
+    /* The stream is finished only once it is closed and everything has been popped */
+    {
+      SPSCByteStream bs { 8 };
+
+      bs.writer().push( "ab" );
+      expect( "not finished while open", not bs.reader().is_finished() );
+      bs.writer().close();
+      expect( "closed", bs.writer().is_closed() );
+      expect( "not finished with bytes buffered", not bs.reader().is_finished() );
+      bs.reader().pop( 1 );
+      expect( "not finished with one byte buffered", not bs.reader().is_finished() );
+      bs.reader().pop( 1 );
+      expect( "finished", bs.reader().is_finished() and bs.reader().bytes_popped() == 2 );
+    }
+
+    /* set_error() is visible from both sides and wakes both */
+    {
+      SPSCByteStream bs { 2 };
+
+      bs.writer().push( "ab" );
+      expect( "no error", not bs.has_error() );
+      bs.set_error();
+      expect( "an error", bs.reader().has_error() and bs.writer().has_error() );
+      expect( "the reader woken", bs.readable_event().consume() );
+      expect( "the writer woken", bs.writable_event().consume() );
+      bs.reader().pop( 2 );
+      expect( "no reader sleep after an error", not bs.reader().request_wakeup() );
+      bs.writer().push( "cd" );
+      expect( "no writer sleep after an error", not bs.writer().request_wakeup() );
+    }
+
+    /* The reader's eventfd is notified only when the reader asked for it */
+    {
+      SPSCByteStream bs { 8 };
+
+      bs.writer().push( "a" );
+      expect( "no notification without a request", not bs.readable_event().consume() );
+      expect( "no sleep with a byte buffered", not bs.reader().request_wakeup() );
+      bs.writer().push( "b" );
+      expect( "a withdrawn request not to notify", not bs.readable_event().consume() );
+
+      bs.reader().pop( 2 );
+      expect( "a sleep on an empty stream", bs.reader().request_wakeup() );
+      expect( "no notification before the push", not bs.readable_event().consume() );
+      bs.writer().push( "c" );
+      expect( "the push to notify", bs.readable_event().consume() );
+      bs.writer().push( "d" );
+      expect( "one notification per request", not bs.readable_event().consume() );
+
+      bs.reader().pop( 2 );
+      expect( "a sleep on an empty stream", bs.reader().request_wakeup() );
+      bs.writer().close();
+      expect( "close() to notify", bs.readable_event().consume() );
+      expect( "no sleep on a closed stream", not bs.reader().request_wakeup() );
+    }
+
+    /* The writer's eventfd is notified only when the writer asked for it */
+    {
+      SPSCByteStream bs { 2 };
+
+      bs.writer().push( "ab" );
+      expect( "a sleep on a full stream", bs.writer().request_wakeup() );
+      expect( "no notification before the pop", not bs.writable_event().consume() );
+      bs.reader().pop( 1 );
+      expect( "the pop to notify", bs.writable_event().consume() );
+      bs.reader().pop( 1 );
+      expect( "one notification per request", not bs.writable_event().consume() );
+      expect( "no sleep with space available", not bs.writer().request_wakeup() );
+    }
+
+    /* Two threads hand data through a small ring, each sleeping on its eventfd */
+    {
+      constexpr uint64_t total = 1'000'000;
+      SPSCByteStream bs { 1000 };
+      string data;
+      for ( uint64_t i = 0; i < total; ++i ) {
+        data.push_back( static_cast<char>( 'a' + i % 26 ) );
+      }
+
+      const auto wait_for = []( EventFD& event ) {
+        pollfd pfd { event.fd_num(), POLLIN, 0 };
+        ::poll( &pfd, 1, -1 );
+        event.consume();
+      };
+
+      thread writer_thread( [&] {
+        uint64_t offset = 0;
+        while ( offset < data.size() ) {
+          const uint64_t pushed = bs.writer().push( string_view { data }.substr( offset, 333 ) );
+          offset += pushed;
+          if ( pushed == 0 and bs.writer().request_wakeup() ) {
+            wait_for( bs.writable_event() );
+          }
+        }
+        bs.writer().close();
+      } );
+
+      string output;
+      while ( not bs.reader().is_finished() ) {
+        const auto peeked = bs.reader().peek();
+        if ( peeked.empty() ) {
+          if ( bs.reader().request_wakeup() ) {
+            wait_for( bs.readable_event() );
+          }
+          continue;
+        }
+        output += peeked;
+        bs.reader().pop( peeked.size() );
+      }
+      writer_thread.join();
+
+      expect( "the data read to match the data written", output == data );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+#include "exception.hh"
+#include "file_descriptor.hh"
+#include "spsc_byte_stream.hh"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <poll.h>
+#include <random>
+#include <sys/socket.h>
+#include <thread>
+
+using namespace std;
+using namespace std::chrono;
+
+// Sleep until the eventfd is notified, then reset it
+static void wait_for( EventFD& event )
+{
+  pollfd pfd { event.fd_num(), POLLIN, 0 };
+  CheckSystemCall( "poll", ::poll( &pfd, 1, -1 ) );
+  event.consume();
+}
+
+static void report( const string_view what, const size_t input_len, const duration<double> test_duration )
+{
+  auto bytes_per_second = static_cast<double>( input_len ) / test_duration.count();
+  auto bits_per_second = 8 * bytes_per_second;
+  auto gigabits_per_second = bits_per_second / 1e9;
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << what << " reached " << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
+
+  debug_output << "             " << what << " throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
+               << " Gbit/s\n";
+
+  if ( gigabits_per_second < 0.1 ) {
+    throw runtime_error( string { what } + " did not meet minimum speed of 0.1 Gbit/s." );
+  }
+}
+
+// Writer thread pushes the data into an SPSCByteStream; this thread reads it back out
+void spsc_speed_test( const string& data,
+                      const size_t capacity,   // NOLINT(bugprone-easily-swappable-parameters)
+                      const size_t write_size, // NOLINT(bugprone-easily-swappable-parameters)
+                      const size_t read_size ) // NOLINT(bugprone-easily-swappable-parameters)
+{
+  SPSCByteStream bs { capacity };
+  string output_data;
+  output_data.reserve( data.size() );
+
+  const auto start_time = steady_clock::now();
+
+  thread writer_thread( [&] {
+    size_t offset = 0;
+    while ( offset < data.size() ) {
+      const size_t pushed = bs.writer().push( string_view { data }.substr( offset, write_size ) );
+      offset += pushed;
+      if ( pushed == 0 and bs.writer().request_wakeup() ) {
+        wait_for( bs.writable_event() );
+      }
+    }
+    bs.writer().close();
+  } );
+
+  while ( not bs.reader().is_finished() ) {
+    const auto peeked = bs.reader().peek().substr( 0, read_size );
+    if ( peeked.empty() ) {
+      if ( bs.reader().request_wakeup() ) {
+        wait_for( bs.readable_event() );
+      }
+      continue;
+    }
+    output_data += peeked;
+    bs.reader().pop( peeked.size() );
+  }
+
+  writer_thread.join();
+  const auto stop_time = steady_clock::now();
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and read" );
+  }
+
+  report( "SPSCByteStream with capacity=" + to_string( capacity ) + ", write_size=" + to_string( write_size )
+            + ", read_size=" + to_string( read_size ),
+          data.size(),
+          duration_cast<duration<double>>( stop_time - start_time ) );
+}
+
+// The same handoff through an AF_UNIX socketpair, as TCPMinnowSocket does between its two threads
+void socketpair_speed_test( const string& data,
+                            const size_t write_size, // NOLINT(bugprone-easily-swappable-parameters)
+                            const size_t read_size ) // NOLINT(bugprone-easily-swappable-parameters)
+{
+  array<int, 2> fds {};
+  CheckSystemCall( "socketpair", ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds.data() ) );
+  FileDescriptor writer_end { fds[0] };
+  FileDescriptor reader_end { fds[1] };
+
+  string output_data;
+  output_data.reserve( data.size() );
+  string buffer;
+
+  const auto start_time = steady_clock::now();
+
+  thread writer_thread( [&] {
+    size_t offset = 0;
+    while ( offset < data.size() ) {
+      offset += writer_end.write( string_view { data }.substr( offset, write_size ) );
+    }
+    writer_end.close();
+  } );
+
+  while ( not reader_end.eof() ) {
+    buffer.resize( read_size );
+    reader_end.read( buffer );
+    output_data += buffer;
+  }
+
+  writer_thread.join();
+  const auto stop_time = steady_clock::now();
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and read" );
+  }
+
+  report( "AF_UNIX socketpair with write_size=" + to_string( write_size ) + ", read_size=" + to_string( read_size ),
+          data.size(),
+          duration_cast<duration<double>>( stop_time - start_time ) );
+}
+
+void program_body()
+{
+  const string data = [] {
+    default_random_engine rd { 789 };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < 1e8; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  spsc_speed_test( data, 64000, 1500, 1500 );
+  socketpair_speed_test( data, 1500, 1500 );
+  spsc_speed_test( data, 1048576, 16384, 16384 );
+  socketpair_speed_test( data, 16384, 16384 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
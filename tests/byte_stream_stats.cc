@@ -0,0 +1,70 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+// The counters only move in a -DMINNOW_STREAM_STATS=ON build; otherwise they must stay zero.
+static uint64_t counted( uint64_t n )
+{
+  return ByteStream::kCountStats ? n : 0;
+}
+
+int main()
+{
+  try {
+    for ( const auto mode : { ByteStream::Mode::Ring, ByteStream::Mode::Chunks, ByteStream::Mode::Mirrored } ) {
+      {
+        ByteStreamTestHarness test { "stats: high-water mark", 10, mode };
+
+        test.execute( HighWaterMark { 0 } );
+        test.execute( Push { "abcd" } );
+        test.execute( HighWaterMark { counted( 4 ) } );
+        test.execute( Pop { 3 } );
+        test.execute( Push { "efg" } );
+        test.execute( HighWaterMark { counted( 4 ) } );
+        test.execute( Push { "hijkl" } );
+        test.execute( HighWaterMark { counted( 9 ) } );
+        test.execute( TruncatedPushes { 0 } );
+      }
+
+      {
+        ByteStreamTestHarness test { "stats: truncated pushes", 4, mode };
+
+        test.execute( Push { "abc" } );
+        test.execute( TruncatedPushes { 0 } );
+        test.execute( Push { "def" } );
+        test.execute( TruncatedPushes { counted( 1 ) } );
+        test.execute( Push { "g" } );
+        test.execute( TruncatedPushes { counted( 2 ) } );
+        test.execute( Pop { 2 } );
+        test.execute( ReserveAndCommit { "hij" } );
+        test.execute( TruncatedPushes { counted( 3 ) } );
+        test.execute( Push { "" } );
+        test.execute( TruncatedPushes { counted( 3 ) } );
+        test.execute( HighWaterMark { counted( 4 ) } );
+      }
+
+      {
+        ByteStreamTestHarness test { "stats: empty reads", 10, mode };
+
+        test.execute( PeekOnce { "" } );
+        test.execute( EmptyReads { counted( 1 ) } );
+        test.execute( PeekAll { "" } );
+        test.execute( EmptyReads { counted( 2 ) } );
+        test.execute( Push { "ab" } );
+        test.execute( PeekOnce { "ab" } );
+        test.execute( EmptyReads { counted( 2 ) } );
+        test.execute( ReadAll { "ab" } );
+        test.execute( EmptyReads { counted( 2 ) } );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
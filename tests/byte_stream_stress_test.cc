@@ -5,9 +5,10 @@
 
 using namespace std;
 
-void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable-parameters)
-                  const size_t capacity,     // NOLINT(bugprone-easily-swappable-parameters)
-                  const size_t random_seed ) // NOLINT(bugprone-easily-swappable-parameters)
+void stress_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
+                  const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                  const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                  const ByteStream::Mode mode )
 {
   default_random_engine rd { random_seed };
 
@@ -21,7 +22,8 @@ void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable
   }();
 
   ByteStreamTestHarness bs { "stress test input=" + to_string( input_len ) + ", capacity=" + to_string( capacity ),
-                             capacity };
+                             capacity,
+                             mode };
 
   size_t expected_bytes_pushed {};
   size_t expected_bytes_popped {};
@@ -56,6 +58,13 @@ void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable
     }
 
     bs.execute( PeekOnce { data.substr( expected_bytes_popped, peek_size ) } );
+    bs.execute( PeekAll { data.substr( expected_bytes_popped, expected_bytes_pushed - expected_bytes_popped ) } );
+
+    const size_t buffered = expected_bytes_pushed - expected_bytes_popped;
+    const size_t peek_offset = uniform_int_distribution<size_t> { 0, buffered }( rd );
+    const size_t peek_len = uniform_int_distribution<size_t> { 0, buffered - peek_offset + 1 }( rd );
+    const size_t peeked = min( peek_len, buffered - peek_offset );
+    bs.execute( PeekAt { peek_offset, peek_len, data.substr( expected_bytes_popped + peek_offset, peeked ) } );
 
     uniform_int_distribution<size_t> bytes_to_pop_dist { 0, peek_size };
     const size_t amount_to_pop = bytes_to_pop_dist( rd );
@@ -72,10 +81,12 @@ void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable
 
 void program_body()
 {
-  stress_test( 19, 3, 10110 );
-  stress_test( 18, 17, 12345 );
-  stress_test( 1111, 17, 98765 );
-  stress_test( 4097, 4096, 11101 );
+  for ( const auto mode : { ByteStream::Mode::Ring, ByteStream::Mode::Chunks, ByteStream::Mode::Mirrored } ) {
+    stress_test( 19, 3, 10110, mode );
+    stress_test( 18, 17, 12345, mode );
+    stress_test( 1111, 17, 98765, mode );
+    stress_test( 4097, 4096, 11101, mode );
+  }
 }
 
 int main()
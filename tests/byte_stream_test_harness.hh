@@ -3,6 +3,7 @@
 #include "byte_stream.hh"
 #include "common.hh"
 
+#include <algorithm>
 #include <concepts>
 #include <optional>
 #include <utility>
@@ -16,11 +17,26 @@ static_assert( sizeof( Writer ) == sizeof( ByteStream ),
 class ByteStreamTestHarness : public TestHarness<ByteStream>
 {
 public:
-  ByteStreamTestHarness( std::string test_name, uint64_t capacity )
-    : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity } )
+  ByteStreamTestHarness( std::string test_name, uint64_t capacity, ByteStream::Mode mode = ByteStream::Mode::Ring )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity ) + mode_suffix( mode ),
+                   ByteStream { capacity, mode } )
   {}
 
   size_t peek_size() { return object().reader().peek().size(); }
+
+private:
+  static std::string mode_suffix( ByteStream::Mode mode )
+  {
+    switch ( mode ) {
+      case ByteStream::Mode::Chunks:
+        return ", chunks";
+      case ByteStream::Mode::Mirrored:
+        return ", mirrored";
+      default:
+        return "";
+    }
+  }
 };
 
 /* actions */
@@ -34,6 +50,24 @@ struct Push : public Action<ByteStream>
   void execute( ByteStream& bs ) const override { bs.writer().push( data_ ); }
 };
 
+struct ReserveAndCommit : public Action<ByteStream>
+{
+  std::string data_;
+
+  explicit ReserveAndCommit( std::string data ) : data_( move( data ) ) {}
+  std::string description() const override
+  {
+    return "reserve " + std::to_string( data_.size() ) + " bytes, fill with \"" + Printer::prettify( data_ )
+           + "\" and commit what fits";
+  }
+  void execute( ByteStream& bs ) const override
+  {
+    const auto space = bs.writer().reserve( data_.size() );
+    std::copy_n( data_.begin(), space.size(), space.begin() );
+    bs.writer().commit( space.size() );
+  }
+};
+
 struct Close : public Action<ByteStream>
 {
   std::string description() const override { return "close"; }
@@ -107,6 +141,74 @@ struct PeekOnce : public Peek
   }
 };
 
+struct PeekAll : public Expectation<ByteStream>
+{
+  std::string output_;
+  std::optional<size_t> regions_ {};
+
+  explicit PeekAll( std::string output ) : output_( move( output ) ) {}
+
+  PeekAll& with_regions( size_t regions )
+  {
+    regions_ = regions;
+    return *this;
+  }
+
+  std::string description() const override
+  {
+    return "peek_all() gives \"" + Printer::prettify( output_ ) + "\""
+           + ( regions_.has_value() ? " in " + std::to_string( regions_.value() ) + " region(s)" : "" );
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    const auto views = bs.reader().peek_all();
+    std::string got;
+    for ( const auto view : views ) {
+      if ( view.empty() ) {
+        throw ExpectationViolation { "Reader::peek_all() returned an empty string_view" };
+      }
+      got += view;
+    }
+
+    if ( got != output_ ) {
+      throw ExpectationViolation { "Expected \"" + Printer::prettify( output_ ) + "\" from peek_all(), "
+                                   + "but found \"" + Printer::prettify( got ) + "\"" };
+    }
+
+    if ( regions_.has_value() and views.size() != regions_.value() ) {
+      throw ExpectationViolation( "number of regions", regions_.value(), views.size() );
+    }
+  }
+};
+
+struct PeekAt : public Expectation<ByteStream>
+{
+  uint64_t offset_;
+  uint64_t len_;
+  std::string output_;
+
+  PeekAt( uint64_t offset, uint64_t len, std::string output )
+    : offset_( offset ), len_( len ), output_( move( output ) )
+  {}
+
+  std::string description() const override
+  {
+    return "peek_at( " + std::to_string( offset_ ) + ", " + std::to_string( len_ ) + " ) gives \""
+           + Printer::prettify( output_ ) + "\"";
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    std::string got;
+    peek_at( bs.reader(), offset_, len_, got );
+    if ( got != output_ ) {
+      throw ExpectationViolation { "Expected \"" + Printer::prettify( output_ ) + "\" from peek_at(), "
+                                   + "but found \"" + Printer::prettify( got ) + "\"" };
+    }
+  }
+};
+
 struct IsClosed : public ConstExpectBool<ByteStream>
 {
   using ConstExpectBool::ConstExpectBool;
@@ -163,6 +265,27 @@ struct BytesPopped : public ExpectNumber<ByteStream, uint64_t>
   size_t value( ByteStream& bs ) const override { return bs.reader().bytes_popped(); }
 };
 
+struct HighWaterMark : public ConstExpectNumber<ByteStream, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().high_water_mark"; }
+  uint64_t value( const ByteStream& bs ) const override { return bs.stats().high_water_mark; }
+};
+
+struct TruncatedPushes : public ConstExpectNumber<ByteStream, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().truncated_pushes"; }
+  uint64_t value( const ByteStream& bs ) const override { return bs.stats().truncated_pushes; }
+};
+
+struct EmptyReads : public ConstExpectNumber<ByteStream, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().empty_reads"; }
+  uint64_t value( const ByteStream& bs ) const override { return bs.stats().empty_reads; }
+};
+
 struct ReadAll : public Expectation<ByteStream>
 {
   std::string output_;
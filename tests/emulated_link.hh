@@ -0,0 +1,226 @@
+#pragma once
+
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// One direction of an emulated network path: a fixed propagation delay and random (or chosen) losses, and
+// optionally a bottleneck that sends queued messages one after another at a fixed rate, and marks ECN-capable
+// ones CE once its queue gets long
+struct LinkConfig
+{
+  uint64_t delay_ms = 10;      // one-way delay
+  double loss_rate = 0;        // probability that each message is dropped
+  std::set<uint64_t> drops {}; // indices (0 = first message sent) of messages to drop regardless
+  std::default_random_engine::result_type seed = 144;
+  uint64_t rate = 0;         // bottleneck rate, in bytes per ms (0: no bottleneck)
+  uint64_t queue_limit = 0;  // bytes the bottleneck queue holds; one that doesn't fit is dropped (0: no limit)
+  uint64_t ce_threshold = 0; // bytes queued from which an ECN-capable arrival is marked CE (0: never)
+};
+
+class EmulatedLink
+{
+  LinkConfig config_;
+  std::default_random_engine rd_ { config_.seed };
+  std::bernoulli_distribution lose_ { config_.loss_rate };
+  std::deque<std::pair<uint64_t, TCPMessage>> in_flight_ {}; // (arrival time, message), in arrival order
+  uint64_t sent_ {};
+
+  // The bottleneck queue: (time the message finishes leaving, its size), for the messages not yet gone
+  std::deque<std::pair<double, uint64_t>> queue_ {};
+  double busy_until_ {};
+  uint64_t queued_bytes_ {};
+  uint64_t max_queued_bytes_ {};
+  uint64_t queue_samples_ {};
+  double queued_bytes_sum_ {};
+  uint64_t ce_marked_ {};
+
+  // Repairs: the dropped data segments (by seqno) still awaiting a delivered copy, with when each was first lost
+  std::map<uint64_t, uint64_t> lost_ {};
+  uint64_t repairs_ {};
+  uint64_t max_repair_ms_ {};
+  uint64_t repair_ms_sum_ {};
+
+  static uint64_t seqno_key( const TCPMessage& msg ) { return msg.sender.seqno.unwrap( Wrap32 { 0 }, 0 ); }
+
+  void lose( const TCPMessage& msg, uint64_t now_ms )
+  {
+    if ( msg.sender.sequence_length() > 0 ) {
+      lost_.try_emplace( seqno_key( msg ), now_ms );
+    }
+  }
+
+  static constexpr uint64_t HEADER_SIZE = 40; // IPv4 and TCP headers, counted against the bottleneck rate
+
+  // Queue `msg` at the bottleneck (marking it CE if it's ECN-capable and the queue is past the threshold).
+  // Returns the time it finishes leaving, or nullopt if the queue is full.
+  std::optional<uint64_t> enqueue( TCPMessage& msg, uint64_t now_ms )
+  {
+    while ( not queue_.empty() and queue_.front().first <= static_cast<double>( now_ms ) ) {
+      queued_bytes_ -= queue_.front().second;
+      queue_.pop_front();
+    }
+    ++queue_samples_;
+    queued_bytes_sum_ += static_cast<double>( queued_bytes_ );
+
+    const uint64_t size = msg.sender.payload.size() + HEADER_SIZE;
+    if ( config_.queue_limit and queued_bytes_ + size > config_.queue_limit ) {
+      return std::nullopt;
+    }
+    const bool ect = msg.sender.ecn == ECN::ECT0 or msg.sender.ecn == ECN::ECT1;
+    if ( config_.ce_threshold and queued_bytes_ >= config_.ce_threshold and ect ) {
+      msg.sender.ecn = ECN::CE;
+      ++ce_marked_;
+    }
+    queued_bytes_ += size;
+    max_queued_bytes_ = std::max( max_queued_bytes_, queued_bytes_ );
+    busy_until_ = std::max( busy_until_, static_cast<double>( now_ms ) )
+                  + static_cast<double>( size ) / static_cast<double>( config_.rate );
+    queue_.emplace_back( busy_until_, size );
+    return static_cast<uint64_t>( std::ceil( busy_until_ ) );
+  }
+
+public:
+  explicit EmulatedLink( LinkConfig config ) : config_( std::move( config ) ) {}
+
+  void send( TCPMessage msg, uint64_t now_ms )
+  {
+    const uint64_t index = sent_++;
+    if ( config_.drops.contains( index ) or lose_( rd_ ) ) {
+      lose( msg, now_ms );
+      return;
+    }
+    uint64_t departure = now_ms;
+    if ( config_.rate ) {
+      const auto finished = enqueue( msg, now_ms );
+      if ( not finished ) {
+        lose( msg, now_ms );
+        return;
+      }
+      departure = *finished;
+    }
+    in_flight_.emplace_back( departure + config_.delay_ms, std::move( msg ) );
+  }
+
+  // Hand every message that has arrived by `now_ms` to `receive`
+  template<class F>
+  void deliver( uint64_t now_ms, F&& receive )
+  {
+    while ( not in_flight_.empty() and in_flight_.front().first <= now_ms ) {
+      TCPMessage msg = std::move( in_flight_.front().second );
+      in_flight_.pop_front();
+      if ( const auto it = lost_.find( seqno_key( msg ) ); it != lost_.end() ) {
+        const uint64_t repair_ms = now_ms - it->second;
+        ++repairs_;
+        max_repair_ms_ = std::max( max_repair_ms_, repair_ms );
+        repair_ms_sum_ += repair_ms;
+        lost_.erase( it );
+      }
+      receive( std::move( msg ) );
+    }
+  }
+
+  uint64_t messages_sent() const { return sent_; }
+  uint64_t messages_marked() const { return ce_marked_; } // CE, at the bottleneck
+
+  // Bytes waiting at the bottleneck: the most ever, and the average that each arriving message found
+  uint64_t max_queued_bytes() const { return max_queued_bytes_; }
+  double mean_queued_bytes() const
+  {
+    return queue_samples_ ? queued_bytes_sum_ / static_cast<double>( queue_samples_ ) : 0;
+  }
+
+  // Time from dropping a data segment until a retransmission of it arrived: the longest, and the average
+  uint64_t max_repair_ms() const { return max_repair_ms_; }
+  double mean_repair_ms() const
+  {
+    return repairs_ ? static_cast<double>( repair_ms_sum_ ) / static_cast<double>( repairs_ ) : 0;
+  }
+};
+
+struct TransferResult
+{
+  uint64_t elapsed_ms;      // virtual time until the receiver had read every byte
+  uint64_t segments_sent;   // by the sending peer, including retransmissions
+  uint64_t max_queue_bytes; // the most bytes ever queued at the forward bottleneck (0 without one)
+  double mean_queue_bytes;  // the average queue each forward message found at the bottleneck
+  uint64_t acks_sent;       // by the receiving peer
+  uint64_t ce_marks;        // messages marked CE at the forward bottleneck
+  uint64_t max_repair_ms;   // the longest any lost data segment took to arrive after it was dropped
+  double mean_repair_ms;    // the average of that over every lost data segment
+};
+
+// Send `len` bytes from one TCPPeer to another over the emulated path, in 1 ms steps of virtual time
+inline TransferResult emulated_transfer( const TCPConfig& sender_cfg,
+                                         const TCPConfig& receiver_cfg,
+                                         const LinkConfig& forward, // NOLINT(bugprone-easily-swappable-parameters)
+                                         const LinkConfig& reverse,
+                                         uint64_t len,
+                                         uint64_t time_limit_ms = 600'000 )
+{
+  TCPPeer sender { sender_cfg };
+  TCPPeer receiver { receiver_cfg };
+  EmulatedLink forward_link { forward };
+  EmulatedLink reverse_link { reverse };
+
+  uint64_t now = 0;
+  const auto sender_transmit = [&]( TCPMessage msg ) { forward_link.send( std::move( msg ), now ); };
+  const auto receiver_transmit = [&]( TCPMessage msg ) { reverse_link.send( std::move( msg ), now ); };
+
+  uint64_t pushed = 0;
+  uint64_t received = 0;
+  const std::string chunk( 65536, 'x' );
+
+  while ( received < len ) {
+    if ( now >= time_limit_ms ) {
+      throw std::runtime_error( "emulated transfer did not finish within " + std::to_string( time_limit_ms )
+                                + " ms (" + std::to_string( received ) + " of " + std::to_string( len )
+                                + " bytes arrived)" );
+    }
+
+    // the receiving application reads each segment as soon as it arrives, so the ACKs advertise open windows
+    Reader& reader = receiver.inbound_reader();
+    forward_link.deliver( now, [&]( TCPMessage msg ) {
+      received += reader.bytes_buffered();
+      reader.pop( reader.bytes_buffered() );
+      receiver.receive( std::move( msg ), receiver_transmit );
+    } );
+    received += reader.bytes_buffered();
+    reader.pop( reader.bytes_buffered() );
+    reverse_link.deliver( now, [&]( TCPMessage msg ) { sender.receive( std::move( msg ), sender_transmit ); } );
+
+    // keep the sender's outbound stream full
+    Writer& writer = sender.outbound_writer();
+    while ( pushed < len and writer.available_capacity() > 0 ) {
+      const uint64_t n = std::min( { len - pushed, writer.available_capacity(), chunk.size() } );
+      writer.push( chunk.substr( 0, n ) );
+      pushed += n;
+    }
+    sender.push( sender_transmit );
+
+    ++now;
+    sender.tick( 1, sender_transmit );
+    receiver.tick( 1, receiver_transmit );
+  }
+
+  return { now,
+           forward_link.messages_sent(),
+           forward_link.max_queued_bytes(),
+           forward_link.mean_queued_bytes(),
+           reverse_link.messages_sent(),
+           forward_link.messages_marked(),
+           forward_link.max_repair_ms(),
+           forward_link.mean_repair_ms() };
+}
@@ -0,0 +1,120 @@
+#include "fd_adapter.hh"
+#include "lossy_fd_adapter.hh"
+
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// An adapter that records what is written to it, and hands back what the test queues up to be read
+class RecordingAdapter : public FdAdapterBase
+{
+  vector<TCPMessage>* written_;
+  queue<TCPMessage>* to_read_;
+
+public:
+  RecordingAdapter( vector<TCPMessage>& written, queue<TCPMessage>& to_read )
+    : written_( &written ), to_read_( &to_read )
+  {}
+
+  void write( const TCPMessage& seg ) { written_->push_back( seg ); }
+
+  optional<TCPMessage> read()
+  {
+    if ( to_read_->empty() ) {
+      return {};
+    }
+    TCPMessage ret = to_read_->front();
+    to_read_->pop();
+    return ret;
+  }
+};
+
+void expect( const string& what, bool condition )
+{
+  if ( not condition ) {
+    throw runtime_error( "expected " + what );
+  }
+}
+
+TCPMessage data_segment( ECN ecn )
+{
+  TCPMessage msg;
+  msg.sender.payload = string( 960, 'x' ); // 1000 bytes with the headers
+  msg.sender.ecn = ecn;
+  return msg;
+}
+
+int main()
+{
+  try {
+    /* Datagrams that find the virtual queue past the threshold are marked, if they are ECN-capable */
+    {
+      vector<TCPMessage> written;
+      queue<TCPMessage> to_read;
+      LossyFdAdapter<RecordingAdapter> adapter { RecordingAdapter { written, to_read } };
+      adapter.config_mut().ce_rate = 1; // one byte per ms: the queue barely drains during the test
+      adapter.config_mut().ce_threshold = 1500;
+
+      adapter.write( data_segment( ECN::ECT0 ) );   // finds an empty queue
+      adapter.write( data_segment( ECN::ECT0 ) );   // finds about 1000 bytes
+      adapter.write( data_segment( ECN::NotECT ) ); // finds about 2000 bytes, but isn't ECN-capable
+      adapter.write( data_segment( ECN::ECT1 ) );   // finds about 3000 bytes
+
+      expect( "every datagram written", written.size() == 4 );
+      expect( "no mark below the threshold",
+              written[0].sender.ecn == ECN::ECT0 and written[1].sender.ecn == ECN::ECT0 );
+      expect( "no mark on a datagram that isn't ECN-capable", written[2].sender.ecn == ECN::NotECT );
+      expect( "a mark past the threshold", written[3].sender.ecn == ECN::CE );
+
+      // the other direction has a queue of its own
+      for ( int i = 0; i < 3; ++i ) {
+        to_read.push( data_segment( ECN::ECT0 ) );
+      }
+      expect( "no mark on an empty downlink queue", adapter.read()->sender.ecn == ECN::ECT0 );
+      expect( "no mark below the downlink threshold", adapter.read()->sender.ecn == ECN::ECT0 );
+      expect( "a mark past the downlink threshold", adapter.read()->sender.ecn == ECN::CE );
+      expect( "nothing more to read", not adapter.read().has_value() );
+    }
+
+    /* The queue drains at the configured rate */
+    {
+      vector<TCPMessage> written;
+      queue<TCPMessage> to_read;
+      LossyFdAdapter<RecordingAdapter> adapter { RecordingAdapter { written, to_read } };
+      adapter.config_mut().ce_rate = 1'000'000'000; // drains faster than the test can write
+      adapter.config_mut().ce_threshold = 1000;
+
+      for ( int i = 0; i < 10; ++i ) {
+        adapter.write( data_segment( ECN::ECT0 ) );
+      }
+      for ( const auto& msg : written ) {
+        expect( "no marks from a fast queue", msg.sender.ecn == ECN::ECT0 );
+      }
+    }
+
+    /* Without a threshold nothing is marked */
+    {
+      vector<TCPMessage> written;
+      queue<TCPMessage> to_read;
+      LossyFdAdapter<RecordingAdapter> adapter { RecordingAdapter { written, to_read } };
+
+      for ( int i = 0; i < 10; ++i ) {
+        adapter.write( data_segment( ECN::ECT0 ) );
+      }
+      for ( const auto& msg : written ) {
+        expect( "no marks without a threshold", msg.sender.ecn == ECN::ECT0 );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
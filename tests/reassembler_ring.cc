@@ -0,0 +1,102 @@
+#include "reassembler.hh"
+#include "ring_reassembler.hh"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace std;
+
+// Feed the same random, overlapping, out-of-order substrings to a Reassembler and a RingReassembler, reading
+// from both at random, and check that they agree at every step.
+void differential_test( const size_t input_len, // NOLINT(bugprone-easily-swappable-parameters)
+                        const size_t capacity,  // NOLINT(bugprone-easily-swappable-parameters)
+                        const size_t max_segment,
+                        const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+
+  const string data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < input_len; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  Reassembler expected { ByteStream { capacity } };
+  RingReassembler actual { ByteStream { capacity } };
+  string expected_output;
+  string actual_output;
+
+  const auto fail = [&]( const string& what ) {
+    throw runtime_error( "RingReassembler disagrees with Reassembler (input=" + to_string( input_len )
+                         + ", capacity=" + to_string( capacity ) + ", seed=" + to_string( random_seed )
+                         + "): " + what );
+  };
+
+  for ( size_t step = 0; not expected.reader().is_finished(); ++step ) {
+    if ( step > 100 * input_len + 1000 ) {
+      fail( "stream never finished" );
+    }
+
+    // insert a substring starting a little before or beyond the next needed byte
+    const uint64_t next = expected.reader().bytes_popped() + expected.reader().bytes_buffered();
+    uniform_int_distribution<uint64_t> start_dist { next > capacity ? next - capacity : 0,
+                                                    min<uint64_t>( next + capacity, data.size() ) };
+    const uint64_t start = start_dist( rd );
+    uniform_int_distribution<size_t> len_dist { 0, min( max_segment, data.size() - start ) };
+    const size_t len = len_dist( rd );
+    const bool last = start + len == data.size();
+
+    expected.insert( start, data.substr( start, len ), last );
+    actual.insert( start, data.substr( start, len ), last );
+
+    if ( expected.bytes_pending() != actual.bytes_pending() ) {
+      fail( "bytes_pending " + to_string( actual.bytes_pending() ) + " instead of "
+            + to_string( expected.bytes_pending() ) );
+    }
+    if ( expected.reader().bytes_buffered() != actual.reader().bytes_buffered() ) {
+      fail( "bytes_buffered differs after inserting " + to_string( len ) + " bytes @ " + to_string( start ) );
+    }
+    if ( expected.writer().is_closed() != actual.writer().is_closed() ) {
+      fail( "is_closed differs" );
+    }
+
+    // read some of the output
+    uniform_int_distribution<uint64_t> read_dist { 0, expected.reader().bytes_buffered() };
+    const uint64_t to_read = read_dist( rd );
+    string chunk;
+    read( expected.reader(), to_read, chunk );
+    expected_output += chunk;
+    read( actual.reader(), to_read, chunk );
+    actual_output += chunk;
+  }
+
+  if ( not actual.reader().is_finished() ) {
+    fail( "stream not finished" );
+  }
+  if ( expected_output != data or actual_output != data ) {
+    fail( "output mismatch" );
+  }
+}
+
+int main()
+{
+  try {
+    differential_test( 19, 3, 4, 10110 );
+    differential_test( 100, 1, 3, 22222 );
+    differential_test( 1000, 65, 100, 12345 );
+    differential_test( 5000, 64, 200, 31337 );
+    differential_test( 20000, 1500, 3000, 98765 );
+    differential_test( 100000, 4096, 1460, 11101 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -1,4 +1,6 @@
+#include "exception.hh"
 #include "reassembler.hh"
+#include "ring_reassembler.hh"
 
 #include <algorithm>
 #include <chrono>
@@ -9,53 +11,75 @@
 #include <queue>
 #include <random>
 #include <tuple>
+#include <typeinfo>
 
 using namespace std;
 using namespace std::chrono;
 
-void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t capacity,     // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t random_seed ) // NOLINT(bugprone-easily-swappable-parameters)
+using Segments = queue<tuple<uint64_t, string, bool>>;
+
+string make_data( const size_t len, const size_t random_seed )
 {
-  // Generate the data to be written
-  const string data = [&] {
-    default_random_engine rd { random_seed };
-    uniform_int_distribution<char> ud;
-    string ret;
-    for ( size_t i = 0; i < num_chunks * capacity; ++i ) {
-      ret += ud( rd );
-    }
-    return ret;
-  }();
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<char> ud;
+  string ret;
+  for ( size_t i = 0; i < len; ++i ) {
+    ret += ud( rd );
+  }
+  return ret;
+}
 
-  // Split the data into segments before writing
-  queue<tuple<uint64_t, string, bool>> split_data;
+// Each chunk is sent as three double-length segments, the first two slightly out of order
+Segments staggered_segments( const string& data, const size_t capacity )
+{
+  Segments split_data;
   for ( size_t i = 0; i < data.size(); i += capacity ) {
     split_data.emplace( i + 2, data.substr( i + 2, capacity * 2 ), i + 2 + capacity * 2 >= data.size() );
     split_data.emplace( i, data.substr( i, capacity * 2 ), i + capacity * 2 >= data.size() );
     split_data.emplace( i + 1, data.substr( i + 1, capacity * 2 ), i + 1 + capacity * 2 >= data.size() );
   }
+  return split_data;
+}
 
-  Reassembler reassembler { ByteStream { capacity } };
+// Within each chunk, `segment_len`-byte segments start every `step` bytes and arrive last-to-first, so they all
+// overlap each other and sit pending until the segment at the start of the chunk fills the gap.
+Segments overlapping_segments( const string& data,
+                               const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                               const size_t segment_len, // NOLINT(bugprone-easily-swappable-parameters)
+                               const size_t step )
+{
+  Segments split_data;
+  for ( size_t chunk = 0; chunk < data.size(); chunk += capacity ) {
+    const size_t chunk_end = min( chunk + capacity, data.size() );
+    for ( size_t k = ( chunk_end - chunk + step - 1 ) / step; k-- > 0; ) {
+      const size_t i = chunk + k * step;
+      const size_t len = min( segment_len, chunk_end - i );
+      split_data.emplace( i, data.substr( i, len ), i + len == data.size() );
+    }
+  }
+  return split_data;
+}
+
+template<class ReassemblerT>
+void speed_test( const string_view workload, const string& data, const size_t capacity, Segments split_data )
+{
+  ReassemblerT reassembler { ByteStream { capacity } };
 
   string output_data;
   output_data.reserve( data.size() );
+  uint64_t max_pending = 0;
 
   const auto start_time = steady_clock::now();
-  int cnt = 0;
   while ( not split_data.empty() ) {
-    cout << "START : " << cnt << endl;
     auto& next = split_data.front();
-    cout << "INDEX : " << get<uint64_t>( next ) << endl;
     reassembler.insert( get<uint64_t>( next ), move( get<string>( next ) ), get<bool>( next ) );
     split_data.pop();
+    max_pending = max( max_pending, reassembler.bytes_pending() );
 
     while ( reassembler.reader().bytes_buffered() ) {
       output_data += reassembler.reader().peek();
       reassembler.reader().pop( output_data.size() - reassembler.reader().bytes_popped() );
     }
-    cout << "END : " << cnt << endl;
-    cnt++;
   }
 
   const auto stop_time = steady_clock::now();
@@ -68,16 +92,20 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
     throw runtime_error( "Mismatch between data written and read" );
   }
 
+  if ( max_pending >= capacity ) {
+    throw runtime_error( "Reassembler held more bytes pending than the stream's capacity" );
+  }
+
   auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
-  auto bytes_per_second = static_cast<double>( num_chunks * capacity ) / test_duration.count();
+  auto bytes_per_second = static_cast<double>( data.size() ) / test_duration.count();
   auto bits_per_second = 8 * bytes_per_second;
   auto gigabits_per_second = bits_per_second / 1e9;
 
   fstream debug_output;
   debug_output.open( "/dev/tty" );
 
-  cout << "Reassembler to ByteStream with capacity=" << capacity << " reached " << fixed << setprecision( 2 )
-       << gigabits_per_second << " Gbit/s.\n";
+  cout << demangle( typeid( ReassemblerT ).name() ) << " to ByteStream with capacity=" << capacity << " ("
+       << workload << ") reached " << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
 
   debug_output << "             Reassembler throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
                << " Gbit/s\n";
@@ -89,7 +117,18 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
 
 void program_body()
 {
-  speed_test( 10000, 1500, 1370 );
+  {
+    const string data = make_data( 10000 * 1500, 1370 );
+    speed_test<Reassembler>( "staggered", data, 1500, staggered_segments( data, 1500 ) );
+    speed_test<RingReassembler>( "staggered", data, 1500, staggered_segments( data, 1500 ) );
+  }
+
+  {
+    // every byte of the chunk is covered by ~16 pending segments before the chunk can be pushed
+    const string data = make_data( 1000 * 64000, 1371 );
+    speed_test<Reassembler>( "heavy overlap", data, 64000, overlapping_segments( data, 64000, 1000, 64 ) );
+    speed_test<RingReassembler>( "heavy overlap", data, 64000, overlapping_segments( data, 64000, 1000, 64 ) );
+  }
 }
 
 int main()
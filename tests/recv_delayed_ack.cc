@@ -0,0 +1,106 @@
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+void expect( const string& what, bool condition )
+{
+  if ( not condition ) {
+    throw runtime_error( "expected " + what );
+  }
+}
+
+int main()
+{
+  try {
+    TCPConfig cfg;
+    cfg.timestamps = false; // full-sized segments of exactly cfg.mss bytes
+    cfg.ack_delay_ms = 40;
+    const Wrap32 isn = cfg.isn;
+
+    TCPPeer client { cfg };
+    TCPPeer server { cfg };
+    vector<TCPMessage> to_server;
+    vector<TCPMessage> to_client;
+    const auto send_to_server = [&]( TCPMessage msg ) { to_server.push_back( move( msg ) ); };
+    const auto send_to_client = [&]( TCPMessage msg ) { to_client.push_back( move( msg ) ); };
+    const auto acked = [&]( uint32_t bytes ) {
+      return to_client.size() == 1 and to_client[0].receiver.ackno == isn + 1 + bytes;
+    };
+
+    client.push( send_to_server );
+    for ( auto& msg : exchange( to_server, {} ) ) {
+      server.receive( move( msg ), send_to_client );
+    }
+    expect( "the SYN to be acknowledged at once", to_client.size() == 1 and to_client[0].sender.SYN );
+    for ( auto& msg : exchange( to_client, {} ) ) {
+      client.receive( move( msg ), send_to_server );
+    }
+    for ( auto& msg : exchange( to_server, {} ) ) {
+      server.receive( move( msg ), send_to_client );
+    }
+    expect( "no reply to a bare ACK", to_client.empty() );
+
+    /* Every second full-sized segment is acknowledged at once; a lone one when the timer fires */
+    client.outbound_writer().push( string( 3000, 'x' ) );
+    client.push( send_to_server );
+    expect( "three data segments", to_server.size() == 3 );
+    vector<TCPMessage> segments = exchange( to_server, {} );
+    server.receive( move( segments[0] ), send_to_client );
+    expect( "the first segment's ACK to wait", to_client.empty() );
+    server.receive( move( segments[1] ), send_to_client );
+    expect( "one ACK for two segments", acked( 2000 ) );
+    to_client.clear();
+    server.receive( move( segments[2] ), send_to_client );
+    server.tick( cfg.ack_delay_ms - 1, send_to_client );
+    expect( "the third segment's ACK to wait", to_client.empty() );
+    server.tick( 1, send_to_client );
+    expect( "the ACK when the timer fires", acked( 3000 ) );
+    to_client.clear();
+
+    /* Out-of-order data, and data that fills the gap, is acknowledged at once */
+    client.outbound_writer().push( string( 2000, 'y' ) );
+    client.push( send_to_server );
+    segments = exchange( to_server, {} );
+    expect( "two more data segments", segments.size() == 2 );
+    server.receive( move( segments[1] ), send_to_client );
+    expect( "a duplicate ACK with a SACK block",
+            acked( 3000 ) and to_client[0].receiver.sack_blocks.size() == 1 );
+    to_client.clear();
+    server.receive( move( segments[0] ), send_to_client );
+    expect( "the filled gap acknowledged at once", acked( 5000 ) );
+    to_client.clear();
+
+    /* A segment the server sends carries the pending ACK, so no separate one follows */
+    client.outbound_writer().push( "hello" );
+    client.push( send_to_server );
+    server.receive( move( exchange( to_server, {} ).at( 0 ) ), send_to_client );
+    expect( "the small segment's ACK to wait", to_client.empty() );
+    server.outbound_writer().push( "hi" );
+    server.push( send_to_client );
+    expect( "the reply to carry the ACK", acked( 5005 ) and to_client[0].sender.payload == "hi" );
+    to_client.clear();
+    server.tick( cfg.ack_delay_ms, send_to_client );
+    expect( "no separate ACK", to_client.empty() );
+
+    /* A FIN is acknowledged at once */
+    client.outbound_writer().close();
+    client.push( send_to_server );
+    server.receive( move( exchange( to_server, {} ).at( 0 ) ), send_to_client );
+    expect( "the FIN acknowledged at once", acked( 5006 ) );
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
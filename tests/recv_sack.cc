@@ -0,0 +1,172 @@
+#include "checksum.hh"
+#include "parser.hh"
+#include "reassembler.hh"
+#include "tcp_receiver.hh"
+#include "tcp_over_ip.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+using Blocks = vector<pair<Wrap32, Wrap32>>;
+
+string describe( const Blocks& blocks )
+{
+  string s;
+  for ( const auto& [left, right] : blocks ) {
+    s += " [" + to_string( left.unwrap( Wrap32 { 0 }, 0 ) ) + ", " + to_string( right.unwrap( Wrap32 { 0 }, 0 ) )
+         + ")";
+  }
+  return s.empty() ? " (none)" : s;
+}
+
+void expect_blocks( const string& name, const Blocks& expected, const Blocks& actual )
+{
+  if ( expected != actual ) {
+    throw runtime_error( name + ": expected SACK blocks" + describe( expected ) + " but got" + describe( actual ) );
+  }
+}
+
+int main()
+{
+  try {
+    const Wrap32 isn { 1000 };
+    const auto at = [&]( uint32_t index ) { return isn + 1 + index; }; // seqno of a stream index
+
+    /* The receiver reports the ranges it holds beyond the ackno, the latest first (RFC 2018) */
+    {
+      TCPReceiver receiver { Reassembler { ByteStream { 4000 } } };
+      TCPSenderMessage syn { isn, true, {}, false, false };
+      syn.sack_permitted = true;
+      receiver.receive( move( syn ) );
+      expect_blocks( "after SYN", {}, receiver.send().sack_blocks );
+
+      receiver.receive( { at( 100 ), false, string( 100, 'x' ), false, false } );
+      receiver.receive( { at( 400 ), false, string( 100, 'x' ), false, false } );
+      receiver.receive( { at( 200 ), false, string( 50, 'x' ), false, false } );
+      expect_blocks(
+        "two ranges", { { at( 100 ), at( 250 ) }, { at( 400 ), at( 500 ) } }, receiver.send().sack_blocks );
+
+      receiver.receive( { at( 300 ), false, string( 50, 'x' ), false, false } );
+      expect_blocks( "three ranges",
+                     { { at( 300 ), at( 350 ) }, { at( 100 ), at( 250 ) }, { at( 400 ), at( 500 ) } },
+                     receiver.send().sack_blocks );
+
+      // filling the first hole moves the ackno past the first range
+      receiver.receive( { at( 0 ), false, string( 100, 'x' ), false, false } );
+      if ( receiver.send().ackno != at( 250 ) ) {
+        throw runtime_error( "ackno should have moved to the second hole" );
+      }
+      expect_blocks( "after the first hole is filled",
+                     { { at( 300 ), at( 350 ) }, { at( 400 ), at( 500 ) } },
+                     receiver.send().sack_blocks );
+
+      // at most four blocks fit
+      for ( const uint32_t index : { 600U, 700U, 800U } ) {
+        receiver.receive( { at( index ), false, string( 10, 'x' ), false, false } );
+      }
+      expect_blocks( "five ranges",
+                     { { at( 800 ), at( 810 ) },
+                       { at( 300 ), at( 350 ) },
+                       { at( 400 ), at( 500 ) },
+                       { at( 600 ), at( 610 ) } },
+                     receiver.send().sack_blocks );
+    }
+
+    /* ... but only if the sender's SYN permitted it */
+    {
+      TCPReceiver receiver { Reassembler { ByteStream { 4000 } } };
+      receiver.receive( { isn, true, {}, false, false } );
+      receiver.receive( { at( 100 ), false, string( 100, 'x' ), false, false } );
+      expect_blocks( "SACK not permitted", {}, receiver.send().sack_blocks );
+    }
+
+    /* The options survive serialization and parsing */
+    {
+      TCPSegment seg;
+      seg.message.sender = { isn, true, string( 10, 'z' ), false, false };
+      seg.message.sender.sack_permitted = true;
+      seg.message.receiver.ackno = Wrap32 { 5000 };
+      seg.message.receiver.window_size = 1234;
+      const Blocks blocks { { Wrap32 { 6000 }, Wrap32 { 7000 } }, { Wrap32 { 8000 }, Wrap32 { 8500 } } };
+      seg.message.receiver.sack_blocks = blocks;
+      seg.compute_checksum( 0 );
+
+      TCPSegment parsed;
+      if ( not parse( parsed, serialize( seg ), 0 ) ) {
+        throw runtime_error( "failed to parse a segment with options" );
+      }
+      if ( not parsed.message.sender.sack_permitted or parsed.message.sender.payload != "zzzzzzzzzz"
+           or parsed.message.receiver.window_size != 1234 ) {
+        throw runtime_error( "segment with options was garbled in parsing" );
+      }
+      expect_blocks( "parsed", blocks, parsed.message.receiver.sack_blocks );
+    }
+
+    /* ... and wrapping in IPv4, whose length and pseudo-header must count them */
+    {
+      TCPMessage msg;
+      msg.sender = { isn, true, string( 10, 'z' ), false, false };
+      msg.sender.sack_permitted = true;
+      msg.receiver.ackno = Wrap32 { 5000 };
+      msg.receiver.sack_blocks = { { Wrap32 { 6000 }, Wrap32 { 7000 } } };
+
+      TCPOverIPv4Adapter adapter;
+      const InternetDatagram dgram = adapter.wrap_tcp_in_ip( msg );
+      uint64_t size = dgram.header.hlen * 4;
+      for ( const auto& buffer : dgram.payload ) {
+        size += buffer.size();
+      }
+      if ( dgram.header.len != size ) {
+        throw runtime_error( "IPv4 length " + to_string( dgram.header.len ) + " but datagram is "
+                             + to_string( size ) + " bytes" );
+      }
+
+      const optional<TCPMessage> unwrapped = adapter.unwrap_tcp_in_ip( dgram );
+      if ( not unwrapped.has_value() or not unwrapped->sender.sack_permitted
+           or unwrapped->sender.payload != msg.sender.payload ) {
+        throw runtime_error( "segment with options did not survive IPv4 wrapping" );
+      }
+      expect_blocks( "unwrapped", msg.receiver.sack_blocks, unwrapped->receiver.sack_blocks );
+    }
+
+    /* A SACK-permitted option padded past its two bytes doesn't hide the options after it */
+    {
+      TCPSegment seg;
+      seg.message.sender = { isn, true, {}, false, false };
+      seg.message.sender.sack_permitted = true;
+      seg.message.receiver.ackno = Wrap32 { 5000 };
+      seg.message.receiver.sack_blocks = { { Wrap32 { 6000 }, Wrap32 { 7000 } } };
+      string raw;
+      for ( const auto& buffer : serialize( seg ) ) {
+        raw += buffer;
+      }
+      raw.replace( 20, 4, string { 4, 4, 0, 0 } ); // was NOP, NOP, kind 4, length 2
+      raw[16] = raw[17] = 0;
+      InternetChecksum check;
+      check.add( raw );
+      raw[16] = static_cast<char>( check.value() >> 8 );
+      raw[17] = static_cast<char>( check.value() & 0xff );
+
+      TCPSegment parsed;
+      if ( not parse( parsed, vector<string> { raw }, 0 ) or not parsed.message.sender.sack_permitted ) {
+        throw runtime_error( "a four-byte SACK-permitted option was not parsed" );
+      }
+      expect_blocks( "after a four-byte SACK-permitted option", seg.message.receiver.sack_blocks,
+                     parsed.message.receiver.sack_blocks );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,113 @@
+#include "parser.hh"
+#include "reassembler.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_receiver.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+void expect_window( const string& name, uint64_t expected, uint64_t actual )
+{
+  if ( expected != actual ) {
+    throw runtime_error( name + ": expected window " + to_string( expected ) + " but got " + to_string( actual ) );
+  }
+}
+
+int main()
+{
+  try {
+    const Wrap32 isn { 1000 };
+    constexpr uint64_t capacity = 1'000'000;
+
+    /* The shift count is the smallest that fits the capacity into 16 bits */
+    {
+      TCPConfig cfg;
+      if ( cfg.window_scale() != 0 ) {
+        throw runtime_error( "the default capacity should not need scaling" );
+      }
+      cfg.recv_capacity = capacity;
+      if ( cfg.window_scale() != 4 ) {
+        throw runtime_error( "a 1 MB capacity should be offered with a shift of 4" );
+      }
+      cfg.window_scaling = false;
+      if ( cfg.window_scale().has_value() ) {
+        throw runtime_error( "window scaling was switched off" );
+      }
+    }
+
+    /* A receiver scales its window only if the peer's SYN offered scaling too */
+    {
+      TCPReceiver receiver { Reassembler { ByteStream { capacity } }, 4 };
+      TCPSenderMessage syn { isn, true, {}, false, false };
+      syn.window_scale = 7;
+      receiver.receive( move( syn ) );
+      expect_window( "scaled", capacity >> 4, receiver.send().window_size );
+      receiver.receive( { isn + 1, false, string( 1000, 'x' ), false, false } );
+      expect_window( "scaled, after 1000 bytes", ( capacity - 1000 ) >> 4, receiver.send().window_size );
+    }
+    {
+      TCPReceiver receiver { Reassembler { ByteStream { capacity } }, 4 };
+      receiver.receive( { isn, true, {}, false, false } );
+      expect_window( "peer did not offer scaling", UINT16_MAX, receiver.send().window_size );
+    }
+
+    /* The option survives serialization and parsing */
+    {
+      TCPSegment seg;
+      seg.message.sender = { isn, true, {}, false, false };
+      seg.message.sender.sack_permitted = true;
+      seg.message.sender.window_scale = 9;
+      seg.compute_checksum( 0 );
+
+      TCPSegment parsed;
+      if ( not parse( parsed, serialize( seg ), 0 ) ) {
+        throw runtime_error( "failed to parse a SYN with the window-scale option" );
+      }
+      const auto& parsed_syn = parsed.message.sender;
+      if ( parsed_syn.window_scale != optional<uint8_t> { 9 } or not parsed_syn.sack_permitted ) {
+        throw runtime_error( "window-scale option was garbled in parsing" );
+      }
+    }
+
+    /* Between two peers: the SYNs carry unscaled windows, and later segments scaled ones */
+    {
+      TCPConfig cfg;
+      cfg.recv_capacity = capacity;
+      TCPPeer client { cfg };
+      TCPPeer server { cfg };
+      vector<TCPMessage> to_server;
+      vector<TCPMessage> to_client;
+      const auto send_to_server = [&]( TCPMessage msg ) { to_server.push_back( move( msg ) ); };
+      const auto send_to_client = [&]( TCPMessage msg ) { to_client.push_back( move( msg ) ); };
+
+      client.push( send_to_server );
+      if ( to_server.size() != 1 or to_server[0].sender.window_scale != optional<uint8_t> { 4 } ) {
+        throw runtime_error( "client SYN should offer a window-scale shift of 4" );
+      }
+      server.receive( move( to_server[0] ), send_to_client );
+      if ( to_client.size() != 1 or not to_client[0].sender.SYN ) {
+        throw runtime_error( "server should answer with a SYN" );
+      }
+      expect_window( "SYN-ACK", UINT16_MAX, to_client[0].receiver.window_size );
+      client.receive( move( to_client[0] ), send_to_server );
+      if ( to_server.size() != 2 ) {
+        throw runtime_error( "client should acknowledge the server's SYN" );
+      }
+      expect_window( "ACK of SYN", capacity >> 4, to_server[1].receiver.window_size );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+#include "reassembler.hh"
+#include "tcp_receiver.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+void expect( const string& what, bool condition )
+{
+  if ( not condition ) {
+    throw runtime_error( "expected " + what );
+  }
+}
+
+int main()
+{
+  try {
+    /* The stream index keeps counting while the seqnos wrap around */
+    {
+      constexpr uint64_t total = ( 1UL << 32 ) + 1'000'000;
+      constexpr uint64_t segment = 60000; // large segments, to keep the test short
+      const Wrap32 isn { 1U << 31 };
+
+      TCPReceiver receiver { Reassembler { ByteStream { 2 * segment } } };
+      TCPSenderMessage syn { isn, true, {}, false, false };
+      syn.sack_permitted = true;
+      receiver.receive( move( syn ) );
+
+      uint64_t received = 0; // stream index of the next byte
+      string data;
+      const auto message = [&]( uint64_t index ) {
+        data.assign( segment, static_cast<char>( 'a' + index / segment % 26 ) );
+        return TCPSenderMessage { Wrap32::wrap( index + 1, isn ), false, data, false, false };
+      };
+      const auto read_all = [&] {
+        expect( "the data at stream index " + to_string( received ),
+                receiver.reader().peek() == data and receiver.reader().bytes_buffered() == segment );
+        receiver.reader().pop( segment );
+      };
+
+      while ( received < total ) {
+        receiver.receive( message( received ) );
+        received += segment;
+        if ( receiver.send().ackno != Wrap32::wrap( received + 1, isn ) ) {
+          throw runtime_error( "no ACK of the segment ending at stream index " + to_string( received ) );
+        }
+        read_all();
+      }
+
+      // out of order past the wrap: the later segment waits for the earlier one
+      receiver.receive( message( received + segment ) );
+      expect( "a SACK block", receiver.send().sack_blocks.size() == 1 );
+      expect( "the ackno held back", receiver.send().ackno == Wrap32::wrap( received + 1, isn ) );
+      receiver.receive( message( received ) );
+      expect( "both segments acknowledged",
+              receiver.send().ackno == Wrap32::wrap( received + 2 * segment + 1, isn ) );
+      expect( "both segments assembled", receiver.reader().bytes_buffered() == 2 * segment );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,77 @@
+#include "parser.hh"
+#include "reassembler.hh"
+#include "tcp_receiver.hh"
+#include "tcp_segment.hh"
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// An in-order payload should reach the inbound stream of a Chunks-mode ByteStream without being copied: the
+// bytes the reader peeks at are the very buffer the payload arrived in.
+void expect_same_buffer( const string& name, const char* original, string_view peeked, size_t len )
+{
+  if ( peeked.size() != len ) {
+    throw runtime_error( name + ": peek() returned " + to_string( peeked.size() ) + " bytes instead of "
+                         + to_string( len ) );
+  }
+  if ( peeked.data() != original ) {
+    throw runtime_error( name + ": payload was copied on its way into the stream" );
+  }
+}
+
+int main()
+{
+  try {
+    constexpr size_t len = 1000;
+
+    /* Reassembler, in-order insert */
+    {
+      Reassembler reassembler { ByteStream { 4000, ByteStream::Mode::Chunks } };
+      string data( len, 'x' );
+      const char* original = data.data();
+      reassembler.insert( 0, move( data ), false );
+      expect_same_buffer( "Reassembler", original, reassembler.reader().peek(), len );
+    }
+
+    /* TCPReceiver, SYN then data */
+    {
+      TCPReceiver receiver { Reassembler { ByteStream { 4000, ByteStream::Mode::Chunks } } };
+      const Wrap32 isn { 12345 };
+      receiver.receive( { isn, true, {}, false, false } );
+
+      TCPSenderMessage msg { isn + 1, false, string( len, 'y' ), false, false };
+      const char* original = msg.payload.data();
+      receiver.receive( move( msg ) );
+      expect_same_buffer( "TCPReceiver", original, receiver.reader().peek(), len );
+    }
+
+    /* parsing a segment from moved buffers hands over the payload buffer */
+    {
+      TCPSegment seg;
+      seg.message.sender = { Wrap32 { 1 }, false, string( len, 'z' ), false, false };
+      seg.compute_checksum( 0 );
+      vector<string> buffers = serialize( seg );
+      if ( buffers.size() != 2 ) {
+        throw runtime_error( "expected header and payload to serialize as separate buffers" );
+      }
+      const char* original = buffers.back().data();
+
+      TCPSegment parsed;
+      if ( not parse( parsed, move( buffers ), 0 ) ) {
+        throw runtime_error( "failed to parse serialized segment" );
+      }
+      expect_same_buffer( "parse", original, parsed.message.sender.payload, len );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
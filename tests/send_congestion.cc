@@ -0,0 +1,194 @@
+#include "congestion_control.hh"
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// Follow CUBIC's window from a loss at 100 segments, with one ACK per 100 ms RTT: it should rise quickly at
+// first, flatten out near the old maximum at time K, then probe beyond it.
+void cubic_curve()
+{
+  constexpr uint64_t mss = 1000;
+  constexpr uint64_t rtt = 100;
+  Cubic cc { mss };
+  while ( cc.cwnd() < 100 * mss ) {
+    cc.on_ack( 2 * mss, 0, rtt );
+  }
+  cc.on_loss( cc.cwnd(), 0 );
+  if ( cc.cwnd() != 70 * mss or cc.ssthresh() != 70 * mss ) {
+    throw runtime_error( "CUBIC: cwnd should drop to 0.7 * W_max after a loss, but it is "
+                         + to_string( cc.cwnd() ) );
+  }
+
+  const auto k_ms = static_cast<uint64_t>( cbrt( 30 / Cubic::C ) * 1000 );
+  const auto check = [&]( uint64_t now, uint64_t low, uint64_t high ) {
+    if ( cc.cwnd() < low or cc.cwnd() > high ) {
+      throw runtime_error( "CUBIC: at t=" + to_string( now ) + " ms, cwnd=" + to_string( cc.cwnd() )
+                           + " should have been in [" + to_string( low ) + ", " + to_string( high ) + "]" );
+    }
+  };
+
+  for ( uint64_t now = rtt; now <= 2 * k_ms; now += rtt ) {
+    cc.on_ack( cc.cwnd(), now, rtt );
+    if ( now == rtt ) {
+      check( now, 71 * mss, 75 * mss ); // steep
+    } else if ( now == k_ms / 2 / rtt * rtt ) {
+      check( now, 95 * mss, 98 * mss ); // concave, approaching W_max
+    } else if ( now == k_ms / rtt * rtt ) {
+      check( now, 99 * mss, 101 * mss ); // plateau
+    }
+  }
+  check( 2 * k_ms, 110 * mss, 130 * mss ); // convex, probing for more
+}
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rt_timeout = 100;
+      cfg.rt_timeout_min = 100; // ACKs arrive with no time passing, so keep the RTO from dropping below this
+      cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "NewReno slow start and timeout", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( ExpectCongestionWindow { 10000 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // the initial window is ten segments, although the receiver would take more
+      test.execute( Push { string( 20000, 'x' ) } );
+      for ( unsigned i = 0; i < 10; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ).with_seqno( isn + 1 + i * 1000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 10000 } );
+
+      // slow start: each ACK grows cwnd by the bytes it acknowledges (up to two segments' worth)
+      test.execute( AckReceived { Wrap32 { isn + 1 + 2000 } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 12000 } );
+      for ( unsigned i = 10; i < 14; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + i * 1000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+
+      // timeout: ssthresh is half the flight size, and cwnd falls to one segment
+      test.execute( Tick { 99 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 2000 ) );
+      test.execute( ExpectCongestionWindow { 1000 } );
+      test.execute( ExpectSlowStartThreshold { 6000 } );
+      test.execute( Tick { 200 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 2000 ) );
+      test.execute( ExpectSlowStartThreshold { 6000 } );
+
+      test.execute( AckReceived { Wrap32 { isn + 1 + 14000 } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 3000 } );
+      for ( unsigned i = 14; i < 17; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + i * 1000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 17000 } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 5000 } );
+
+      // slow start ends at ssthresh
+      test.execute( AckReceived { Wrap32 { isn + 1 + 20000 } }.with_win( 60000 ).without_push() );
+      test.execute( ExpectCongestionWindow { 6000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "Window is the smaller of cwnd and rwnd", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 3000 ) );
+      test.execute( Push { string( 5000, 'x' ) } );
+      for ( unsigned i = 0; i < 3; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + i * 1000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 3000 } }.with_win( 60000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 3000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 4000 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::Cubic;
+
+      TCPSenderTestHarness test { "Zero-window probes leave cwnd alone", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 0 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( ExpectCongestionWindow { 10000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.pacing = true;
+
+      TCPSenderTestHarness test { "Pacing spreads the window out", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectSRTT { 100 } );
+
+      // the rate is 2 * cwnd / SRTT = 200 bytes per ms in slow start, and the budget starts at two segments
+      test.execute( Push { string( 10000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 5 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 2000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 10 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 3000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 4000 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // a long tick's worth can go out at once, but no more than the burst carries over to the next tick
+      test.execute( Tick { 50 } );
+      test.execute( Tick { 1 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 5000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 6000 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    cubic_curve();
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+#include "parser.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+void expect( const string& what, bool condition )
+{
+  if ( not condition ) {
+    throw runtime_error( "expected " + what );
+  }
+}
+
+TCPMessage round_trip( const TCPMessage& message )
+{
+  TCPSegment seg { .message = message };
+  seg.compute_checksum( 0 );
+  TCPSegment parsed;
+  expect( "the segment to parse", parse( parsed, serialize( seg ), 0 ) );
+  return parsed.message;
+}
+
+struct Connection
+{
+  TCPPeer client;
+  TCPPeer server;
+  vector<TCPMessage> to_server {};
+  vector<TCPMessage> to_client {};
+
+  Connection( bool client_ecn, bool server_ecn )
+    : client( config( client_ecn ) ), server( config( server_ecn ) )
+  {
+    client.push( [&]( TCPMessage msg ) { to_server.push_back( move( msg ) ); } );
+    expect( "the SYN to offer ECN only if configured to", to_server.at( 0 ).sender.ecn_setup == client_ecn );
+    to_server_receive();
+    expect( "the SYN-ACK to accept ECN only if both sides offer it",
+            to_client.at( 0 ).sender.ecn_setup == ( client_ecn and server_ecn ) );
+    to_client_receive();
+    to_server_receive();
+  }
+
+  static TCPConfig config( bool ecn )
+  {
+    TCPConfig cfg;
+    cfg.ecn = ecn;
+    cfg.timestamps = false;
+    return cfg;
+  }
+
+  // deliver every message queued for one side, collecting its replies
+  void to_server_receive()
+  {
+    for ( auto& msg : exchange( to_server, {} ) ) {
+      server.receive( move( msg ), [&]( TCPMessage reply ) { to_client.push_back( move( reply ) ); } );
+    }
+  }
+  void to_client_receive()
+  {
+    for ( auto& msg : exchange( to_client, {} ) ) {
+      client.receive( move( msg ), [&]( TCPMessage reply ) { to_server.push_back( move( reply ) ); } );
+    }
+  }
+
+  void client_sends( const string& data )
+  {
+    client.outbound_writer().push( data );
+    client.push( [&]( TCPMessage msg ) { to_server.push_back( move( msg ) ); } );
+  }
+};
+
+int main()
+{
+  try {
+    /* The flags survive serialization and parsing: ECE and CWR on a SYN, ECE alone on a SYN-ACK */
+    {
+      TCPMessage syn;
+      syn.sender.SYN = true;
+      syn.sender.ecn_setup = true;
+      const TCPMessage parsed_syn = round_trip( syn );
+      expect( "an ECN-setup SYN", parsed_syn.sender.ecn_setup and not parsed_syn.receiver.ECE );
+
+      TCPMessage syn_ack = syn;
+      syn_ack.receiver.ackno = Wrap32 { 1 };
+      expect( "an ECN-setup SYN-ACK", round_trip( syn_ack ).sender.ecn_setup );
+
+      TCPMessage data;
+      data.sender.payload = "abc";
+      data.sender.CWR = true;
+      data.receiver.ackno = Wrap32 { 1 };
+      data.receiver.ECE = true;
+      const TCPMessage parsed_data = round_trip( data );
+      expect( "ECE and CWR", parsed_data.receiver.ECE and parsed_data.sender.CWR );
+      data.sender.CWR = data.receiver.ECE = false;
+      const TCPMessage parsed_plain = round_trip( data );
+      expect( "neither ECE nor CWR", not parsed_plain.receiver.ECE and not parsed_plain.sender.CWR );
+    }
+
+    /* Only new data goes out ECN-capable, and only if both sides agreed to ECN */
+    {
+      Connection both { true, true };
+      both.client_sends( "hello" );
+      expect( "data sent ECT(0)", both.to_server.at( 0 ).sender.ecn == ECN::ECT0 );
+      both.to_server_receive();
+      expect( "a pure ACK sent not-ECT", both.to_client.at( 0 ).sender.ecn == ECN::NotECT );
+
+      Connection one { true, false };
+      one.client_sends( "hello" );
+      expect( "data sent not-ECT without the server's agreement", one.to_server.at( 0 ).sender.ecn == ECN::NotECT );
+    }
+
+    /* A CE mark is echoed until the sender answers with CWR, and reduces the window once, with no retransmission */
+    {
+      Connection c { true, true };
+      c.client_sends( string( 3000, 'x' ) );
+      expect( "three data segments", c.to_server.size() == 3 );
+      c.to_server.at( 0 ).sender.ecn = ECN::CE;
+      TCPMessage third = move( c.to_server.at( 2 ) );
+      c.to_server.pop_back();
+      c.to_server_receive();
+      expect( "ECE on the ACKs",
+              c.to_client.size() == 2 and c.to_client[0].receiver.ECE and c.to_client[1].receiver.ECE );
+
+      c.to_client_receive();
+      const uint64_t ssthresh = c.client.sender().slow_start_threshold();
+      expect( "ssthresh reduced", ssthresh == 2000 );
+      expect( "no retransmission", c.to_server.empty() );
+
+      // the next new segment says the window was reduced, and the echo stops once it arrives
+      c.client_sends( string( 1000, 'y' ) );
+      expect( "CWR on new data", c.to_server.size() == 1 and c.to_server[0].sender.CWR );
+      c.to_server.insert( c.to_server.begin(), move( third ) );
+      c.to_server_receive();
+      expect( "ECE until CWR arrives", c.to_client.size() == 2 and c.to_client[0].receiver.ECE );
+      expect( "no ECE after CWR", not c.to_client[1].receiver.ECE );
+      c.to_client_receive();
+      expect( "one reduction for the window", c.client.sender().slow_start_threshold() == ssthresh );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rt_timeout_min = 1000; // keep the timer out of the way
+
+      TCPSenderTestHarness test { "Fast retransmit and NewReno recovery", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 20000, 'x' ) } );
+      for ( unsigned i = 0; i < 10; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + i * 1000 ) );
+      }
+      test.execute( AckReceived { Wrap32 { isn + 1 + 1000 } }.with_win( 60000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 10000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 11000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 11000 } );
+
+      // the segment at 1000 is lost; the three segments after it each produce a duplicate ACK
+      test.execute( AckReceived { Wrap32 { isn + 1 + 1000 } }.with_win( 60000 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 1000 } }.with_win( 60000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInFastRecovery { false } );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 1000 } }.with_win( 60000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInFastRecovery { true } );
+      test.execute( ExpectCongestionWindow { 5500 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+
+      // more duplicates inflate the window until new data can go out
+      for ( unsigned i = 0; i < 3; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 1 + 1000 } }.with_win( 60000 ) );
+      }
+      test.execute( ExpectMessage {}.with_payload_size( 500 ).with_seqno( isn + 1 + 12000 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 1000 } }.with_win( 60000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 12500 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // a partial ACK means the segment at 5000 was lost too: it is resent at once
+      test.execute( AckReceived { Wrap32 { isn + 1 + 5000 } }.with_win( 60000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 5000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 13500 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInFastRecovery { true } );
+
+      // a full ACK ends recovery, with cwnd at ssthresh
+      test.execute( AckReceived { Wrap32 { isn + 1 + 12000 } }.with_win( 60000 ) );
+      test.execute( ExpectInFastRecovery { false } );
+      test.execute( ExpectCongestionWindow { 5500 } );
+      for ( unsigned i = 0; i < 3; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 14500 + i * 1000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Window updates are not duplicate ACKs", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 2000 ) );
+      test.execute( Push { string( 5000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      for ( const uint16_t win : { 1000, 1500, 1000 } ) {
+        test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( win ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInFastRecovery { false } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.fast_retransmit = false;
+
+      TCPSenderTestHarness test { "Fast retransmit can be turned off", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 5000, 'x' ) } );
+      for ( unsigned i = 0; i < 5; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + i * 1000 ) );
+      }
+      for ( unsigned i = 0; i < 4; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
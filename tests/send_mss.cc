@@ -0,0 +1,116 @@
+#include "parser.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+void expect_mss( const string& name, uint64_t expected, uint64_t actual )
+{
+  if ( expected != actual ) {
+    throw runtime_error( name + ": expected MSS " + to_string( expected ) + " but got " + to_string( actual ) );
+  }
+}
+
+// Two TCPPeers that exchange SYNs (and then data) by hand
+struct Connection
+{
+  TCPPeer client;
+  TCPPeer server;
+  vector<TCPMessage> to_server {};
+  vector<TCPMessage> to_client {};
+
+  Connection( const TCPConfig& client_cfg, const TCPConfig& server_cfg )
+    : client( client_cfg ), server( server_cfg )
+  {}
+
+  void client_send() { client.push( [&]( TCPMessage msg ) { to_server.push_back( move( msg ) ); } ); }
+
+  void deliver()
+  {
+    while ( not to_server.empty() or not to_client.empty() ) {
+      vector<TCPMessage> msgs = move( to_server );
+      to_server.clear();
+      for ( auto& msg : msgs ) {
+        server.receive( move( msg ), [&]( TCPMessage reply ) { to_client.push_back( move( reply ) ); } );
+      }
+      msgs = move( to_client );
+      to_client.clear();
+      for ( auto& msg : msgs ) {
+        client.receive( move( msg ), [&]( TCPMessage reply ) { to_server.push_back( move( reply ) ); } );
+      }
+    }
+  }
+};
+
+int main()
+{
+  try {
+    /* Each side sends segments no larger than the smaller of the two MSS options */
+    {
+      TCPConfig client_cfg;
+      client_cfg.mss = 1460;
+      TCPConfig server_cfg;
+      server_cfg.mss = 1200;
+      Connection conn { client_cfg, server_cfg };
+
+      conn.client_send();
+      if ( conn.to_server.size() != 1 or conn.to_server[0].sender.mss != optional<uint16_t> { 1460 } ) {
+        throw runtime_error( "client SYN should carry an MSS option of 1460" );
+      }
+      expect_mss( "client before the handshake", 1460, conn.client.sender().mss() );
+      conn.deliver();
+      expect_mss( "client", 1200, conn.client.sender().mss() );
+      expect_mss( "server", 1200, conn.server.sender().mss() );
+
+      conn.client.outbound_writer().push( string( 5000, 'x' ) );
+      conn.client_send();
+      const size_t expected = 1200 - TCPConfig::TIMESTAMPS_SPACE;
+      if ( conn.to_server.empty() or conn.to_server[0].sender.payload.size() != expected ) {
+        throw runtime_error( "client should send segments of 1200 bytes, less the timestamps option" );
+      }
+    }
+
+    /* Without the option, the peer is assumed to take 536 bytes */
+    {
+      TCPConfig cfg;
+      cfg.mss = 1460;
+      TCPPeer peer { cfg };
+      TCPSenderMessage syn { Wrap32 { 5 }, true, {}, false, false };
+      peer.receive( { syn, {} }, []( const TCPMessage& /* msg */ ) {} );
+      expect_mss( "peer without MSS option", TCPConfig::DEFAULT_PEER_MSS, peer.sender().mss() );
+    }
+
+    /* The option survives serialization and parsing */
+    {
+      TCPSegment seg;
+      seg.message.sender = { Wrap32 { 1 }, true, {}, false, false };
+      seg.message.sender.mss = 8960;
+      seg.message.sender.window_scale = 3;
+      seg.compute_checksum( 0 );
+
+      TCPSegment parsed;
+      if ( not parse( parsed, serialize( seg ), 0 ) ) {
+        throw runtime_error( "failed to parse a SYN with the MSS option" );
+      }
+      if ( parsed.message.sender.mss != optional<uint16_t> { 8960 }
+           or parsed.message.sender.window_scale != optional<uint8_t> { 3 } ) {
+        throw runtime_error( "MSS option was garbled in parsing" );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.nagle = true;
+
+      TCPSenderTestHarness test {
+        "Nagle coalesces small writes while data is unacknowledged", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) );
+
+      // the first small write goes out at once: nothing is unacknowledged
+      test.execute( Push { "hello" } );
+      test.execute( ExpectMessage {}.with_data( "hello" ).with_seqno( isn + 1 ) );
+
+      // the next ones wait for its ACK, then go out together
+      test.execute( Push { " there" } );
+      test.execute( Push { ", how" } );
+      test.execute( Push { " are you?" } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 5 } }.with_win( 10000 ) );
+      test.execute( ExpectMessage {}.with_data( " there, how are you?" ).with_seqno( isn + 1 + 5 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // a full segment never waits, but the small remainder does
+      test.execute( Push { string( 1500, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 25 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 1025 } }.with_win( 10000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 500 ).with_seqno( isn + 1 + 1025 ) );
+
+      // the FIN is never held back
+      test.execute( Close {} );
+      test.execute( ExpectMessage {}.with_fin( true ).with_payload_size( 0 ).with_seqno( isn + 1 + 1525 ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.nagle = true;
+
+      TCPSenderTestHarness test { "NODELAY sends small writes at once", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) );
+      test.execute( Push { "a" } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( Push { "b" } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( SetNoDelay { true } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_data( "b" ) );
+      test.execute( Push { "c" } );
+      test.execute( ExpectMessage {}.with_data( "c" ) );
+      test.execute( ExpectSeqnosInFlight { 3 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test {
+        "Cork holds back partial segments until uncorked", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) );
+      test.execute( SetCork { true } );
+
+      // even with nothing unacknowledged, and NODELAY set
+      test.execute( SetNoDelay { true } );
+      test.execute( Push { "header: " } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push { string( 1200, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( SetCork { false } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_payload_size( 208 ).with_seqno( isn + 1 + 1000 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test {
+        "Cork holds a partial segment for at most 200 ms", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) );
+      test.execute( SetCork { true } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 150 } );
+      test.execute( Push { "def" } ); // more writes don't restart the wait
+      test.execute( Tick { 49 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abcdef" ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // still corked: the next partial segment waits its own 200 ms
+      test.execute( AckReceived { Wrap32 { isn + 1 + 6 } }.with_win( 10000 ) );
+      test.execute( Push { "ghi" } );
+      test.execute( Tick { 199 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "ghi" ).with_seqno( isn + 1 + 6 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
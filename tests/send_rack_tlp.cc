@@ -0,0 +1,202 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rack_tlp = true;
+
+      TCPSenderTestHarness test {
+        "A tail loss probe goes out after two SRTTs", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectSRTT { 100 } );
+      test.execute( ExpectRTO { 300 } );
+
+      // the probe resends the last segment well before the RTO, and only once
+      test.execute( Push { string( 2000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 ) );
+      test.execute( Tick { 199 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+
+      // and the RTO still fires on time, counted from when the data was sent
+      test.execute( Tick { 99 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectConsecutiveRetransmissions { 1 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rack_tlp = true;
+      cfg.rt_timeout_min = 1000;
+
+      TCPSenderTestHarness test {
+        "A lone segment's probe allows for a delayed ACK", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectRTO { 1000 } );
+
+      // two SRTTs plus a worst-case delayed ACK of 200 ms
+      test.execute( Push { "hello" } );
+      test.execute( ExpectMessage {}.with_data( "hello" ).with_seqno( isn + 1 ) );
+      test.execute( Tick { 399 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "hello" ).with_seqno( isn + 1 ) );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+      test.execute( Tick { 599 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "hello" ).with_seqno( isn + 1 ) );
+      test.execute( ExpectConsecutiveRetransmissions { 1 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rack_tlp = true;
+
+      TCPSenderTestHarness test {
+        "The probe is due no later than the RTO", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectRTO { 300 } );
+
+      // a lone segment's probe would be due at 400 ms, after the RTO: the timeout's retransmission goes instead
+      test.execute( Push { "hello" } );
+      test.execute( ExpectMessage {}.with_data( "hello" ).with_seqno( isn + 1 ) );
+      test.execute( Tick { 299 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "hello" ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectConsecutiveRetransmissions { 1 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rack_tlp = true;
+
+      TCPSenderTestHarness test {
+        "An ACK of the probe counts as a loss to congestion control", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 3000, 'x' ) } );
+      for ( unsigned i = 0; i < 3; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + i * 1000 ) );
+      }
+      test.execute( AckReceived { Wrap32 { isn + 1 + 1000 } }.with_win( 60000 ) );
+      test.execute( Tick { 200 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 2000 ) );
+      test.execute( ExpectSlowStartThreshold { UINT64_MAX } );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 3000 } }.with_win( 60000 ) );
+      test.execute( ExpectSlowStartThreshold { 2000 } );
+      test.execute( ExpectInFastRecovery { false } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rack_tlp = true;
+      const auto at = [&]( uint32_t offset ) { return Wrap32 { isn + 1 + offset }; };
+
+      TCPSenderTestHarness test {
+        "RACK deems a segment lost once a later one is SACKed", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_sack_permitted( true ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { at( 0 ) }.with_win( 60000 ) );
+      test.execute( Push { string( 4000, 'x' ) } );
+      for ( unsigned i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( i * 1000 ) ) );
+      }
+
+      // one SACK is far short of three duplicate ACKs, but the segment before it should have arrived by now
+      // (within a reordering window of a quarter of the minimum RTT)
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { at( 0 ) }.with_win( 60000 ).with_sack( at( 1000 ), at( 2000 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 24 } );
+      test.execute( Push {} );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( 0 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInFastRecovery { true } );
+      test.execute( ExpectSlowStartThreshold { 2000 } );
+
+      // the segments sent with the SACKed one are not yet overdue
+      test.execute( AckReceived { at( 0 ) }.with_win( 60000 ).with_sack( at( 1000 ), at( 3000 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { at( 4000 ) }.with_win( 60000 ) );
+      test.execute( ExpectInFastRecovery { false } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      const auto at = [&]( uint32_t offset ) { return Wrap32 { isn + 1 + offset }; };
+
+      TCPSenderTestHarness test { "Without RACK, one SACK is not enough", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_sack_permitted( true ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { at( 0 ) }.with_win( 60000 ) );
+      test.execute( Push { string( 4000, 'x' ) } );
+      for ( unsigned i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( i * 1000 ) ) );
+      }
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { at( 0 ) }.with_win( 60000 ).with_sack( at( 1000 ), at( 2000 ) ) );
+      test.execute( Tick { 100 } );
+      test.execute( Push {} );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInFastRecovery { false } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -168,6 +168,59 @@ int main()
       test.execute( ExpectSeqnosInFlight { 0 } );
       test.execute( ExpectNoSegment {} );
     }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.send_capacity = 3000;
+
+      // unacknowledged bytes stay in the outbound stream, and retransmissions read them back from it
+      TCPSenderTestHarness test { "Retransmit from the send buffer", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) );
+      test.execute( Push { string( 1000, 'a' ) + string( 1000, 'b' ) + string( 1000, 'c' ) } );
+      test.execute( ExpectMessage {}.with_data( string( 1000, 'a' ) ) );
+      test.execute( ExpectMessage {}.with_data( string( 1000, 'b' ) ) );
+      test.execute( ExpectMessage {}.with_data( string( 1000, 'c' ) ) );
+      test.execute( ExpectAvailableCapacity { 0 } );
+
+      // the space freed by an ACK is reused (the ring wraps around) while later bytes are still in flight
+      test.execute( AckReceived { Wrap32 { isn + 1 + 1000 } }.with_win( 10000 ) );
+      test.execute( ExpectAvailableCapacity { 1000 } );
+      test.execute( Push { string( 1000, 'd' ) } );
+      test.execute( ExpectMessage {}.with_data( string( 1000, 'd' ) ) );
+      test.execute( ExpectAvailableCapacity { 0 } );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_data( string( 1000, 'b' ) ).with_seqno( isn + 1 + 1000 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 3000 } }.with_win( 10000 ) );
+      test.execute( ExpectAvailableCapacity { 2000 } );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_data( string( 1000, 'd' ) ).with_seqno( isn + 1 + 3000 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 4000 } }.with_win( 10000 ) );
+      test.execute( ExpectAvailableCapacity { 3000 } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      // the timer starts when data is sent, however long the sender was idle before
+      TCPSenderTestHarness test { "Retx timer starts with the first segment after idle", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) );
+      test.execute( Tick { 5UL * cfg.rt_timeout } );
+      test.execute( Push { "hi" } );
+      test.execute( ExpectMessage {}.with_data( "hi" ) );
+      test.execute( Tick { cfg.rt_timeout - 1U } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "hi" ).with_seqno( isn + 1 ) );
+    }
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
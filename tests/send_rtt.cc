@@ -0,0 +1,109 @@
+#include "random.hh"
+#include "rtt_estimator.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// The RFC 6298 arithmetic on its own
+void estimator_arithmetic()
+{
+  RTTEstimator est { 1000, 10, 60000 };
+  if ( est.has_samples() or est.RTO_ms() != 1000 ) {
+    throw runtime_error( "RTTEstimator should start with the initial RTO and no samples" );
+  }
+  est.sample( 100 ); // SRTT = 100, RTTVAR = 50
+  if ( est.srtt() != 100 or est.rttvar() != 50 or est.RTO_ms() != 300 ) {
+    throw runtime_error( "RTTEstimator: wrong estimate after the first sample" );
+  }
+  est.sample( 200 ); // RTTVAR = 3/4 * 50 + 1/4 * 100, then SRTT = 7/8 * 100 + 1/8 * 200
+  if ( est.srtt() != 112.5 or est.rttvar() != 62.5 or est.RTO_ms() != 363 or est.min_rtt() != 100 ) {
+    throw runtime_error( "RTTEstimator: wrong estimate after the second sample" );
+  }
+  for ( unsigned i = 0; i < 100; ++i ) {
+    est.sample( 1 );
+  }
+  if ( est.RTO_ms() != 10 ) {
+    throw runtime_error( "RTTEstimator: RTO should be held at the minimum" );
+  }
+}
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rt_timeout_min = 10;
+
+      TCPSenderTestHarness test { "RTO follows the measured RTT", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( ExpectRTO { 1000 } );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSRTT { 50 } );
+      test.execute( ExpectRTO { 150 } ); // 50 + 4 * 25
+
+      test.execute( Push { "hello" } );
+      test.execute( ExpectMessage {}.with_data( "hello" ) );
+      test.execute( Tick { 30 } );
+      test.execute( AckReceived { Wrap32 { isn + 6 } } );
+      test.execute( ExpectSRTT { 47 } ); // 47.5
+      test.execute( ExpectRTO { 143 } ); // 47.5 + 4 * 23.75, rounded up
+
+      // the timer uses the new RTO, and backs off from it
+      test.execute( Push { "world" } );
+      test.execute( ExpectMessage {}.with_data( "world" ) );
+      test.execute( Tick { 142 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "world" ) );
+      test.execute( ExpectRTO { 286 } );
+      test.execute( Tick { 286 } );
+      test.execute( ExpectMessage {}.with_data( "world" ) );
+      test.execute( ExpectRTO { 572 } );
+
+      // Karn's rule: the ACK of a retransmitted segment is no sample, but it does end the backoff
+      test.execute( Tick { 5 } );
+      test.execute( AckReceived { Wrap32 { isn + 11 } } );
+      test.execute( ExpectSRTT { 47 } );
+      test.execute( ExpectRTO { 143 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rt_timeout_max = 5000;
+
+      TCPSenderTestHarness test { "Backoff stops at the maximum RTO", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      for ( const uint64_t rto : { 1000, 2000, 4000, 5000, 5000 } ) {
+        test.execute( ExpectRTO { rto } );
+        test.execute( Tick { rto - 1 } );
+        test.execute( ExpectNoSegment {} );
+        test.execute( Tick { 1 } );
+        test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      }
+      test.execute( ExpectRTO { 5000 } );
+    }
+
+    estimator_arithmetic();
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,177 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rt_timeout_min = 1000; // keep the timer out of the way
+      const auto at = [&]( uint32_t offset ) { return isn + 1 + offset; };
+
+      TCPSenderTestHarness test {
+        "SACK recovery repairs two holes in one round trip", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_sack_permitted( true ).with_seqno( isn ) );
+      test.execute( AckReceived { at( 0 ) }.with_win( 60000 ) );
+      test.execute( Push { string( 20000, 'x' ) } );
+      for ( unsigned i = 0; i < 10; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( i * 1000 ) ) );
+      }
+      test.execute( AckReceived { at( 2000 ) }.with_win( 60000 ) );
+      for ( unsigned i = 10; i < 14; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( i * 1000 ) ) );
+      }
+      test.execute( ExpectNoSegment {} );
+
+      // the segments at 2000 and 5000 are lost; the receiver SACKs what arrives after them
+      test.execute( AckReceived { at( 2000 ) }.with_win( 60000 ).with_sack( at( 3000 ), at( 4000 ) ) );
+      test.execute( AckReceived { at( 2000 ) }.with_win( 60000 ).with_sack( at( 3000 ), at( 5000 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { at( 2000 ) }
+                      .with_win( 60000 )
+                      .with_sack( at( 6000 ), at( 7000 ) )
+                      .with_sack( at( 3000 ), at( 5000 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( 2000 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInFastRecovery { true } );
+      test.execute( ExpectCongestionWindow { 6000 } );
+
+      // once three segments' worth is SACKed above it, the second hole is deemed lost and resent
+      test.execute( AckReceived { at( 2000 ) }
+                      .with_win( 60000 )
+                      .with_sack( at( 6000 ), at( 8000 ) )
+                      .with_sack( at( 3000 ), at( 5000 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { at( 2000 ) }
+                      .with_win( 60000 )
+                      .with_sack( at( 6000 ), at( 9000 ) )
+                      .with_sack( at( 3000 ), at( 5000 ) ) );
+      test.execute( ExpectNoSegment {} ); // but only when the pipe is below cwnd
+      test.execute( AckReceived { at( 2000 ) }
+                      .with_win( 60000 )
+                      .with_sack( at( 6000 ), at( 10000 ) )
+                      .with_sack( at( 3000 ), at( 5000 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( 5000 ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      // partial ACKs don't resend what the scoreboard already repaired, and new data fills the pipe back to cwnd
+      test.execute( AckReceived { at( 5000 ) }.with_win( 60000 ).with_sack( at( 6000 ), at( 10000 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( 14000 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { at( 10000 ) }.with_win( 60000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( 15000 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInFastRecovery { true } );
+
+      test.execute( AckReceived { at( 14000 ) }.with_win( 60000 ) );
+      test.execute( ExpectInFastRecovery { false } );
+      test.execute( ExpectCongestionWindow { 6000 } );
+      for ( unsigned i = 16; i < 20; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( i * 1000 ) ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      const auto at = [&]( uint32_t offset ) { return isn + 1 + offset; };
+
+      TCPSenderTestHarness test {
+        "Recovery starts once the SACKs show a loss", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { at( 0 ) }.with_win( 60000 ) );
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( unsigned i = 0; i < 10; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( i * 1000 ) ) );
+      }
+
+      // the other duplicate ACKs were lost, but this one SACKs more than three segments past the hole
+      test.execute( AckReceived { at( 0 ) }.with_win( 60000 ).with_sack( at( 1000 ), at( 5000 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( 0 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInFastRecovery { true } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rt_timeout_min = 1000; // keep the timer out of the way
+      const auto at = [&]( uint32_t offset ) { return isn + 1 + offset; };
+
+      TCPSenderTestHarness test {
+        "SACK recovery resends every lost hole in one round", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { at( 0 ) }.with_win( 60000 ) );
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( unsigned i = 0; i < 10; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( i * 1000 ) ) );
+      }
+
+      // the segments at 0, 2000 and 4000 are lost, and each has enough SACKed above it to count as lost
+      test.execute( AckReceived { at( 0 ) }
+                      .with_win( 60000 )
+                      .with_sack( at( 5000 ), at( 10000 ) )
+                      .with_sack( at( 3000 ), at( 4000 ) )
+                      .with_sack( at( 1000 ), at( 2000 ) ) );
+      test.execute( ExpectInFastRecovery { true } );
+      test.execute( ExpectCongestionWindow { 5000 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( 0 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( 2000 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( 4000 ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      // nothing is resent twice, and the holes' ACK ends recovery
+      test.execute( AckReceived { at( 2000 ) }
+                      .with_win( 60000 )
+                      .with_sack( at( 5000 ), at( 10000 ) )
+                      .with_sack( at( 3000 ), at( 4000 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { at( 10000 ) }.with_win( 60000 ) );
+      test.execute( ExpectInFastRecovery { false } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.sack = false;
+      const auto at = [&]( uint32_t offset ) { return isn + 1 + offset; };
+
+      TCPSenderTestHarness test { "SACK disabled", cfg, { ByteStream { 64000 }, cfg } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_sack_permitted( false ) );
+      test.execute( AckReceived { at( 0 ) }.with_win( 60000 ) );
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( unsigned i = 0; i < 10; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( at( i * 1000 ) ) );
+      }
+      test.execute( AckReceived { at( 0 ) }.with_win( 60000 ).with_sack( at( 1000 ), at( 5000 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInFastRecovery { false } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
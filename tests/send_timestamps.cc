@@ -0,0 +1,127 @@
+#include "parser.hh"
+#include "reassembler.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_receiver.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+void expect( const string& what, bool condition )
+{
+  if ( not condition ) {
+    throw runtime_error( "expected " + what );
+  }
+}
+
+// Send `len` bytes from a client to a server whose first data segment is lost, and return the client's latest
+// RTT sample once the retransmission has been acknowledged 30 ms after it was sent
+uint64_t rtt_after_retransmission( bool timestamps )
+{
+  TCPConfig cfg;
+  cfg.timestamps = timestamps;
+  TCPPeer client { cfg };
+  TCPPeer server { cfg };
+  vector<TCPMessage> to_server;
+  vector<TCPMessage> to_client;
+  const auto send_to_server = [&]( TCPMessage msg ) { to_server.push_back( move( msg ) ); };
+  const auto send_to_client = [&]( TCPMessage msg ) { to_client.push_back( move( msg ) ); };
+  const auto deliver = [&] {
+    while ( not to_server.empty() or not to_client.empty() ) {
+      for ( auto& msg : exchange( to_server, {} ) ) {
+        server.receive( move( msg ), send_to_client );
+      }
+      for ( auto& msg : exchange( to_client, {} ) ) {
+        client.receive( move( msg ), send_to_server );
+      }
+    }
+  };
+
+  client.push( send_to_server );
+  deliver();
+  client.outbound_writer().push( string( 500, 'x' ) );
+  client.push( send_to_server );
+  expect( "one data segment", to_server.size() == 1 );
+  to_server.clear(); // lost
+
+  client.tick( client.sender().current_RTO_ms(), send_to_server );
+  expect( "a retransmission", to_server.size() == 1 and to_server[0].sender.payload.size() == 500 );
+  client.tick( 30, send_to_server );
+  deliver();
+  expect( "the retransmission to be acknowledged", client.sender().sequence_numbers_in_flight() == 0 );
+  return client.sender().rtt()->latest_rtt();
+}
+
+int main()
+{
+  try {
+    /* The option survives serialization and parsing, and leaves room for three SACK blocks */
+    {
+      TCPSegment seg;
+      seg.message.sender = { Wrap32 { 1 }, false, "abc", false, false };
+      seg.message.sender.timestamp = 123456;
+      seg.message.receiver.ackno = Wrap32 { 1000 };
+      seg.message.receiver.timestamp_echo = 654321;
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        seg.message.receiver.sack_blocks.emplace_back( Wrap32 { 2000 + i * 100 }, Wrap32 { 2050 + i * 100 } );
+      }
+      seg.compute_checksum( 0 );
+
+      TCPSegment parsed;
+      expect( "the segment to parse", parse( parsed, serialize( seg ), 0 ) );
+      expect( "TSval 123456", parsed.message.sender.timestamp == optional<uint32_t> { 123456 } );
+      expect( "TSecr 654321", parsed.message.receiver.timestamp_echo == optional<uint32_t> { 654321 } );
+      expect( "three SACK blocks", parsed.message.receiver.sack_blocks.size() == 3 );
+      expect( "the payload intact", parsed.message.sender.payload == "abc" );
+    }
+
+    /* The receiver echoes the timestamp of the segment at the left edge of its window, and drops older ones */
+    {
+      const Wrap32 isn { 5000 };
+      const auto segment = [&]( uint32_t index, size_t len, uint32_t timestamp ) {
+        TCPSenderMessage msg { isn + 1 + index, false, string( len, 'x' ), false, false };
+        msg.timestamp = timestamp;
+        return msg;
+      };
+
+      TCPReceiver receiver { Reassembler { ByteStream { 10000 } } };
+      TCPSenderMessage syn { isn, true, {}, false, false };
+      syn.timestamp = 100;
+      receiver.receive( move( syn ) );
+      expect( "the SYN's timestamp echoed", receiver.send().timestamp_echo == optional<uint32_t> { 100 } );
+
+      receiver.receive( segment( 0, 1000, 105 ) );
+      expect( "an in-order segment's timestamp echoed",
+              receiver.send().timestamp_echo == optional<uint32_t> { 105 } );
+      receiver.receive( segment( 2000, 1000, 110 ) );
+      expect( "an out-of-order segment's timestamp not echoed",
+              receiver.send().timestamp_echo == optional<uint32_t> { 105 } );
+
+      receiver.receive( segment( 1000, 1000, 90 ) );
+      expect( "PAWS to drop a segment with an old timestamp", receiver.send().ackno == isn + 1 + 1000 );
+      receiver.receive( segment( 1000, 1000, 111 ) );
+      expect( "the same segment to be accepted with a newer timestamp", receiver.send().ackno == isn + 1 + 3000 );
+      expect( "its timestamp echoed", receiver.send().timestamp_echo == optional<uint32_t> { 111 } );
+    }
+
+    /* Timestamps give an RTT sample even for a retransmitted segment, where Karn's rule allows none */
+    {
+      expect( "a 30 ms sample with timestamps", rtt_after_retransmission( true ) == 30 );
+      expect( "no new sample without timestamps", rtt_after_retransmission( false ) == 0 );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
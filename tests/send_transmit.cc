@@ -167,6 +167,31 @@ int main()
       test.execute( ExpectSeqno { Wrap32 { isn + 1 + 3 } } );
     }
 
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.send_capacity = 100000;
+
+      TCPSenderTestHarness test { "A push that fills a large window sends one batch", cfg };
+      test.execute( Push {}.with_batch() );
+      test.execute( ExpectBatches { 1 } );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( UINT16_MAX ).without_push() );
+      test.execute( Push { string( 100000, 'x' ) }.with_batch() );
+      test.execute( ExpectBatches { 2 } );
+      test.execute( ExpectLastBatchSize { 66 } );
+      for ( uint32_t i = 0; i < 65; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + i * 1000 ) );
+      }
+      test.execute( ExpectMessage {}.with_payload_size( UINT16_MAX - 65000 ).with_seqno( isn + 1 + 65000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { UINT16_MAX } );
+
+      // a push with nothing to send doesn't call the transmit function at all
+      test.execute( Push {}.with_batch() );
+      test.execute( ExpectBatches { 2 } );
+    }
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
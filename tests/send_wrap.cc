@@ -0,0 +1,93 @@
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+void expect( const string& what, bool condition )
+{
+  if ( not condition ) {
+    throw runtime_error( "expected " + what );
+  }
+}
+
+int main()
+{
+  try {
+    /* The absolute sequence numbers pass 2^32 while the 32-bit ones wrap around */
+    {
+      constexpr uint64_t total = ( 1UL << 32 ) + 1'000'000;
+      constexpr uint16_t segment = 60000; // large segments, to keep the test short
+      constexpr uint8_t shift = 2;
+      constexpr uint64_t window = segment << shift; // four segments
+
+      TCPConfig cfg;
+      cfg.isn = Wrap32 { 1U << 31 };
+      cfg.mss = segment;
+      cfg.recv_capacity = window;
+      const Wrap32 isn = cfg.isn;
+      TCPSender sender { ByteStream { window }, cfg };
+
+      sender.push( [&]( const TCPSenderMessage& msg ) { expect( "a SYN", msg.SYN and msg.seqno == isn ); } );
+      sender.set_peer_window_scale( shift );
+      TCPReceiverMessage ack { Wrap32 { isn + 1 }, segment };
+      sender.receive( ack );
+
+      // Send a window at a time, each with different bytes, and acknowledge each window in full
+      uint64_t sent = 0; // stream index of the next byte
+      string data;
+      vector<TCPSenderMessage> segments;
+      const auto send_window = [&] {
+        data.assign( window, static_cast<char>( 'a' + sent / window % 26 ) );
+        sender.writer().push( data );
+        segments.clear();
+        sender.push( [&]( const TCPSenderMessage& msg ) { segments.push_back( msg ); } );
+        expect( "a full window in flight at stream index " + to_string( sent ),
+                sender.sequence_numbers_in_flight() == window and segments.size() == window / segment );
+        for ( uint64_t i = 0; i < segments.size(); ++i ) {
+          if ( segments[i].seqno != Wrap32::wrap( sent + i * segment + 1, isn )
+               or segments[i].payload != data.substr( i * segment, segment ) ) {
+            throw runtime_error( "segment at stream index " + to_string( sent + i * segment ) + " is wrong" );
+          }
+        }
+      };
+
+      while ( sent < total ) {
+        send_window();
+        sent += window;
+        ack.ackno = Wrap32::wrap( sent + 1, isn );
+        sender.receive( ack );
+        if ( sender.sequence_numbers_in_flight() != 0 ) {
+          throw runtime_error( "ACK at stream index " + to_string( sent ) + " left "
+                               + to_string( sender.sequence_numbers_in_flight() ) + " in flight" );
+        }
+      }
+
+      // SACK recovery past the wrap: the first segment is lost, and the rest are SACKed
+      send_window();
+      ack.sack_blocks = { { Wrap32::wrap( sent + segment + 1, isn ), Wrap32::wrap( sent + window + 1, isn ) } };
+      sender.receive( ack );
+      expect( "fast recovery", sender.in_fast_recovery() );
+      vector<TCPSenderMessage> resent;
+      sender.push( [&]( const TCPSenderMessage& msg ) { resent.push_back( msg ); } );
+      expect( "the first segment resent",
+              resent.size() == 1 and resent[0].seqno == segments[0].seqno
+                and resent[0].payload == segments[0].payload );
+      ack.ackno = Wrap32::wrap( sent + window + 1, isn );
+      ack.sack_blocks.clear();
+      sender.receive( ack );
+      expect( "recovery over", not sender.in_fast_recovery() and sender.sequence_numbers_in_flight() == 0 );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -11,6 +11,7 @@
 #include <queue>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 const unsigned int DEFAULT_TEST_WINDOW = 137;
 
@@ -18,11 +19,22 @@ struct SenderAndOutput
 {
   TCPSender sender;
   std::queue<TCPSenderMessage> output {};
+  std::vector<size_t> batches {}; // the size of each batch handed to make_batch_transmit()'s function
 
   auto make_transmit()
   {
     return [&]( const TCPSenderMessage& x ) { output.push( x ); };
   }
+
+  auto make_batch_transmit()
+  {
+    return [&]( TCPSender::Batch batch ) {
+      batches.push_back( batch.size() );
+      for ( const auto& x : batch ) {
+        output.push( x );
+      }
+    };
+  }
 };
 
 inline std::string to_string( const TCPSenderMessage& msg )
@@ -73,6 +85,47 @@ struct ExpectSeqnosInFlight : public ExpectNumber<SenderAndOutput, uint64_t>
   uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.sequence_numbers_in_flight(); }
 };
 
+struct ExpectCongestionWindow : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "congestion_window"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.congestion_window(); }
+};
+
+struct ExpectSlowStartThreshold : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "slow_start_threshold"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.slow_start_threshold(); }
+};
+
+struct ExpectRTO : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "current_RTO_ms"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.current_RTO_ms(); }
+};
+
+struct ExpectSRTT : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "rtt()->srtt() (rounded down)"; }
+  uint64_t value( SenderAndOutput& ss ) const override
+  {
+    if ( not ss.sender.rtt().has_value() ) {
+      throw ExpectationViolation( "TCPSender has no RTT estimator" );
+    }
+    return static_cast<uint64_t>( ss.sender.rtt()->srtt() );
+  }
+};
+
+struct ExpectInFastRecovery : public ExpectBool<SenderAndOutput>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "in_fast_recovery"; }
+  bool value( SenderAndOutput& ss ) const override { return ss.sender.in_fast_recovery(); }
+};
+
 struct ExpectConsecutiveRetransmissions : public ExpectNumber<SenderAndOutput, uint64_t>
 {
   using ExpectNumber::ExpectNumber;
@@ -80,6 +133,27 @@ struct ExpectConsecutiveRetransmissions : public ExpectNumber<SenderAndOutput, u
   uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.consecutive_retransmissions(); }
 };
 
+struct ExpectAvailableCapacity : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "writer().available_capacity()"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.writer().available_capacity(); }
+};
+
+struct ExpectBatches : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "number of batches transmitted"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.batches.size(); }
+};
+
+struct ExpectLastBatchSize : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "size of the last batch transmitted"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.batches.empty() ? 0 : ss.batches.back(); }
+};
+
 struct ExpectNoSegment : public Expectation<SenderAndOutput>
 {
   std::string description() const override { return "nothing to send"; }
@@ -97,6 +171,24 @@ struct SetError : public Action<SenderAndOutput>
   void execute( SenderAndOutput& ss ) const override { ss.sender.writer().set_error(); }
 };
 
+struct SetCork : public Action<SenderAndOutput>
+{
+  bool corked_;
+
+  explicit SetCork( bool corked ) : corked_( corked ) {}
+  std::string description() const override { return corked_ ? "set_cork(true)" : "set_cork(false)"; }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_cork( corked_ ); }
+};
+
+struct SetNoDelay : public Action<SenderAndOutput>
+{
+  bool nodelay_;
+
+  explicit SetNoDelay( bool nodelay ) : nodelay_( nodelay ) {}
+  std::string description() const override { return nodelay_ ? "set_nodelay(true)" : "set_nodelay(false)"; }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_nodelay( nodelay_ ); }
+};
+
 struct HasError : public ExpectBool<SenderAndOutput>
 {
   using ExpectBool::ExpectBool;
@@ -108,20 +200,22 @@ struct Push : public Action<SenderAndOutput>
 {
   std::string data_;
   bool close_ {};
+  bool batch_ {};
 
   explicit Push( std::string data = "" ) : data_( move( data ) ) {}
   std::string description() const override
   {
+    const std::string how = batch_ ? " with a batch transmit function" : "";
     if ( data_.empty() and not close_ ) {
-      return "push TCPSender";
+      return "push TCPSender" + how;
     }
 
     if ( data_.empty() and close_ ) {
-      return "close stream, then push to TCPSender";
+      return "close stream, then push to TCPSender" + how;
     }
 
     return "push \"" + Printer::prettify( data_ ) + "\" to stream" + ( close_ ? ", close it" : "" )
-           + ", then push to TCPSender";
+           + ", then push to TCPSender" + how;
   }
   void execute( SenderAndOutput& ss ) const override
   {
@@ -131,7 +225,11 @@ struct Push : public Action<SenderAndOutput>
     if ( close_ ) {
       ss.sender.writer().close();
     }
-    ss.sender.push( ss.make_transmit() );
+    if ( batch_ ) {
+      ss.sender.push( ss.make_batch_transmit() );
+    } else {
+      ss.sender.push( ss.make_transmit() );
+    }
   }
 
   Push& with_close()
@@ -139,6 +237,12 @@ struct Push : public Action<SenderAndOutput>
     close_ = true;
     return *this;
   }
+
+  Push& with_batch()
+  {
+    batch_ = true;
+    return *this;
+  }
 };
 
 struct Tick : public Action<SenderAndOutput>
@@ -192,7 +296,11 @@ struct Receive : public Action<SenderAndOutput>
   std::string description() const override
   {
     std::ostringstream desc;
-    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size << ")";
+    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size;
+    for ( const auto& [left, right] : msg_.sack_blocks ) {
+      desc << ", sack=" << left << "-" << right;
+    }
+    desc << ")";
     if ( push_ ) {
       desc << ", then push stream to TCPSender";
     }
@@ -213,6 +321,12 @@ struct Receive : public Action<SenderAndOutput>
     }
   }
 
+  Receive& with_sack( Wrap32 left, Wrap32 right )
+  {
+    msg_.sack_blocks.emplace_back( left, right );
+    return *this;
+  }
+
   Receive& without_push()
   {
     push_ = false;
@@ -238,6 +352,7 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
   std::optional<Wrap32> seqno {};
   std::optional<std::string> data {};
   std::optional<size_t> payload_size {};
+  std::optional<bool> sack_permitted {};
 
   ExpectMessage& with_syn( bool syn_ )
   {
@@ -263,6 +378,12 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     return *this;
   }
 
+  ExpectMessage& with_sack_permitted( bool sack_permitted_ )
+  {
+    sack_permitted = sack_permitted_;
+    return *this;
+  }
+
   ExpectMessage& with_seqno( Wrap32 seqno_ )
   {
     seqno = seqno_;
@@ -308,6 +429,9 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     if ( rst.has_value() ) {
       o << ( rst.value() ? " +RST" : " (no RST)" );
     }
+    if ( sack_permitted.has_value() ) {
+      o << ( sack_permitted.value() ? " +SACK-permitted" : " (no SACK-permitted)" );
+    }
     return o.str();
   }
 
@@ -334,13 +458,16 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     if ( rst.has_value() and seg.RST != rst.value() ) {
       throw ExpectationViolation( "RST flag", rst.value(), seg.RST );
     }
+    if ( sack_permitted.has_value() and seg.sack_permitted != sack_permitted.value() ) {
+      throw ExpectationViolation( "SACK-permitted option", sack_permitted.value(), seg.sack_permitted );
+    }
     if ( seqno.has_value() and seg.seqno != seqno.value() ) {
       throw ExpectationViolation( "sequence number", seqno.value(), seg.seqno );
     }
     if ( payload_size.has_value() and seg.payload.size() != payload_size.value() ) {
       throw ExpectationViolation( "payload_size", payload_size.value(), seg.payload.size() );
     }
-    if ( seg.payload.size() > TCPConfig::MAX_PAYLOAD_SIZE ) {
+    if ( seg.payload.size() > ss.sender.mss() ) {
       throw ExpectationViolation( "payload has length (" + std::to_string( seg.payload.size() )
                                   + ") greater than the maximum" );
     }
@@ -361,4 +488,9 @@ public:
                    "initial_RTO_ms=" + to_string( config.rt_timeout ),
                    { TCPSender { ByteStream { config.send_capacity }, config.isn, config.rt_timeout } } )
   {}
+
+  // Test a sender that was constructed some other way (e.g. from the whole config, with congestion control)
+  TCPSenderTestHarness( std::string name, const TCPConfig& config, TCPSender&& sender )
+    : TestHarness( move( name ), "initial_RTO_ms=" + to_string( config.rt_timeout ), { std::move( sender ) } )
+  {}
 };
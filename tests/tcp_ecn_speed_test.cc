@@ -0,0 +1,75 @@
+#include "emulated_link.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+constexpr uint64_t transfer_len = 4'000'000;
+constexpr uint64_t one_way_delay_ms = 10;
+constexpr uint64_t bottleneck_rate = 1250; // bytes per ms: 10 Mbit/s
+
+TCPConfig config( bool ecn )
+{
+  TCPConfig cfg;
+  cfg.ecn = ecn;
+  cfg.send_capacity = 2 * cfg.recv_capacity;
+  return cfg;
+}
+
+TransferResult transfer( bool ecn, const LinkConfig& forward )
+{
+  const LinkConfig reverse { .delay_ms = one_way_delay_ms };
+  return emulated_transfer( config( ecn ), config( ecn ), forward, reverse, transfer_len );
+}
+
+double megabits_per_second( const TransferResult& result )
+{
+  return 8.0 * transfer_len / static_cast<double>( result.elapsed_ms ) / 1000.0;
+}
+
+// A window larger than the path's bandwidth-delay product builds a queue at the bottleneck. Without ECN it grows
+// until the queue overflows and segments are lost; with ECN, marks past a threshold shrink the window first.
+void marked_queue()
+{
+  const LinkConfig bottleneck {
+    .delay_ms = one_way_delay_ms, .rate = bottleneck_rate, .queue_limit = 30'000, .ce_threshold = 10'000 };
+  const auto drop_tail = transfer( false, bottleneck );
+  const auto ecn = transfer( true, bottleneck );
+
+  cout << fixed << setprecision( 1 ) << "Bottleneck (10 Mbit/s, RTT " << 2 * one_way_delay_ms
+       << " ms, 30 KB queue): " << megabits_per_second( drop_tail ) << " Mbit/s, " << drop_tail.segments_sent
+       << " segments sent, " << drop_tail.mean_queue_bytes << " bytes queued on average without ECN; "
+       << megabits_per_second( ecn ) << " Mbit/s, " << ecn.segments_sent << " segments sent, "
+       << ecn.mean_queue_bytes << " bytes queued with ECN (" << ecn.ce_marks << " marked CE past 10 KB).\n";
+
+  if ( ecn.ce_marks == 0 or ecn.segments_sent >= drop_tail.segments_sent ) {
+    throw runtime_error( "ECN marks should stand in for the losses at a full queue" );
+  }
+  if ( ecn.mean_queue_bytes * 2 > drop_tail.mean_queue_bytes ) {
+    throw runtime_error( "ECN should at least halve the average queue at the bottleneck" );
+  }
+  if ( ecn.elapsed_ms * 10 > drop_tail.elapsed_ms * 11 ) {
+    throw runtime_error( "ECN should not slow the transfer by more than 10%" );
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    marked_queue();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,159 @@
+#include "emulated_link.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+constexpr uint64_t transfer_len = 1'000'000;
+constexpr uint64_t one_way_delay_ms = 10;
+
+// How a sender recovers from loss
+enum class Recovery : uint8_t
+{
+  Timer,   // retransmission timer alone
+  NewReno, // fast retransmit and NewReno fast recovery
+  SACK,    // fast retransmit and SACK-based recovery
+  RACK,    // SACK-based recovery, with RACK-TLP loss detection
+};
+
+TCPConfig config( Recovery recovery )
+{
+  TCPConfig cfg;
+  cfg.fast_retransmit = recovery != Recovery::Timer;
+  cfg.sack = recovery == Recovery::SACK or recovery == Recovery::RACK;
+  cfg.rack_tlp = recovery == Recovery::RACK;
+  cfg.send_capacity = 2 * cfg.recv_capacity; // room for new data while a lost window awaits its retransmission
+  return cfg;
+}
+
+TransferResult transfer( Recovery recovery, const LinkConfig& forward, uint64_t len = transfer_len )
+{
+  return emulated_transfer( config( recovery ), config( recovery ), forward, {}, len );
+}
+
+double megabits_per_second( const TransferResult& result )
+{
+  return 8.0 * transfer_len / static_cast<double>( result.elapsed_ms ) / 1000.0;
+}
+
+// Drop one data segment mid-transfer. The repair is the time from the drop until the retransmission arrives:
+// fast retransmit needs about one round trip for the duplicate ACKs to come back, plus the retransmission's trip.
+// The transfer also takes longer than without the loss by the repair plus the round trips spent at a reduced
+// cwnd while it grows back (the receiving application reads each segment as it arrives, so the lossless
+// transfer runs at the full window).
+void single_loss()
+{
+  const LinkConfig lossless { .delay_ms = one_way_delay_ms };
+  const LinkConfig one_drop { .delay_ms = one_way_delay_ms, .drops = { 100 } };
+  constexpr uint64_t rtt = 2 * one_way_delay_ms;
+
+  const uint64_t baseline = transfer( Recovery::NewReno, lossless ).elapsed_ms;
+  const auto fast = transfer( Recovery::NewReno, one_drop );
+  const auto rto_only = transfer( Recovery::Timer, one_drop );
+
+  cout << "One lost segment (RTT " << rtt << " ms) was repaired in " << fast.max_repair_ms
+       << " ms with fast retransmit, " << rto_only.max_repair_ms << " ms waiting for the retransmission timer; "
+       << "the transfer took " << fast.elapsed_ms - baseline << " ms and " << rto_only.elapsed_ms - baseline
+       << " ms longer.\n";
+
+  if ( fast.max_repair_ms > 2 * rtt ) {
+    throw runtime_error( "fast retransmit should repair a single loss within two round trips" );
+  }
+  if ( fast.max_repair_ms >= rto_only.max_repair_ms ) {
+    throw runtime_error( "fast retransmit did not recover from a single loss faster than the timer" );
+  }
+}
+
+// Drop three segments from the same window: NewReno repairs one hole per round trip, SACK all of them at once, so
+// SACK's last repair should come at least a round trip sooner for each hole after the first. (Both reduce cwnd
+// once, so that part of the transfer's cost is the same.)
+void burst_loss()
+{
+  const LinkConfig three_drops { .delay_ms = one_way_delay_ms, .drops = { 100, 103, 106 } };
+  constexpr uint64_t rtt = 2 * one_way_delay_ms;
+  constexpr uint64_t holes = 3;
+
+  const auto sack = transfer( Recovery::SACK, three_drops );
+  const auto newreno = transfer( Recovery::NewReno, three_drops );
+
+  cout << "Three lost segments in one window were all repaired in " << sack.max_repair_ms << " ms with SACK, "
+       << newreno.max_repair_ms << " ms with NewReno.\n";
+
+  if ( sack.max_repair_ms > 2 * rtt ) {
+    throw runtime_error( "SACK should repair every hole in a window within two round trips" );
+  }
+  if ( sack.max_repair_ms + ( holes - 1 ) * rtt > newreno.max_repair_ms ) {
+    throw runtime_error( "SACK did not save a round trip per extra hole over NewReno" );
+  }
+}
+
+// Lose a short message that is the whole flight (as in a request or a reply): no ACK follows it to reveal the
+// loss, so without a tail loss probe it waits for the retransmission timer. The message takes two segments; a
+// lone segment's probe waits for a worst-case delayed ACK as well, and then can't beat a 200 ms minimum RTO.
+void tail_loss()
+{
+  constexpr uint64_t message_len = 1500;
+  const LinkConfig lossless { .delay_ms = one_way_delay_ms };
+  const LinkConfig message_lost { .delay_ms = one_way_delay_ms, .drops = { 1, 2 } }; // after the SYN
+
+  const uint64_t baseline = transfer( Recovery::RACK, lossless, message_len ).elapsed_ms;
+  const uint64_t probe = transfer( Recovery::RACK, message_lost, message_len ).elapsed_ms - baseline;
+  const uint64_t timer = transfer( Recovery::SACK, message_lost, message_len ).elapsed_ms - baseline;
+
+  cout << "A lost " << message_len << "-byte message (RTT " << 2 * one_way_delay_ms << " ms) arrived " << probe
+       << " ms late with a tail loss probe, " << timer << " ms late waiting for the retransmission timer.\n";
+
+  // the probe goes out two SRTTs after the message, and its SACK shows the rest lost about a round trip later
+  if ( probe > 4 * 2 * one_way_delay_ms ) {
+    throw runtime_error( "a tail loss probe should repair a lost message within about four round trips" );
+  }
+}
+
+// Random losses only sometimes leave several holes in one window, so SACK's advantage shows in the average repair
+void random_loss( double loss_rate )
+{
+  const LinkConfig lossy { .delay_ms = one_way_delay_ms, .loss_rate = loss_rate };
+  const auto rack = transfer( Recovery::RACK, lossy );
+  const auto sack = transfer( Recovery::SACK, lossy );
+  const auto newreno = transfer( Recovery::NewReno, lossy );
+  const auto rto_only = transfer( Recovery::Timer, lossy );
+
+  cout << fixed << setprecision( 1 ) << "With " << 100 * loss_rate << "% loss: " << megabits_per_second( rack )
+       << " Mbit/s with RACK-TLP (" << rack.segments_sent << " segments sent), " << megabits_per_second( sack )
+       << " Mbit/s with SACK (" << sack.segments_sent << "), " << megabits_per_second( newreno )
+       << " Mbit/s with NewReno (" << newreno.segments_sent << "), " << megabits_per_second( rto_only )
+       << " Mbit/s with the timer alone (" << rto_only.segments_sent << ").\n";
+  cout << "  A lost segment took " << rack.mean_repair_ms << " ms on average to arrive with RACK-TLP, "
+       << sack.mean_repair_ms << " ms with SACK, " << newreno.mean_repair_ms << " ms with NewReno, "
+       << rto_only.mean_repair_ms << " ms with the timer alone.\n";
+
+  if ( sack.mean_repair_ms > newreno.mean_repair_ms ) {
+    throw runtime_error( "SACK took longer on average than NewReno to repair a hole" );
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    single_loss();
+    burst_loss();
+    tail_loss();
+    for ( const double loss_rate : { 0.005, 0.01, 0.02 } ) {
+      random_loss( loss_rate );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
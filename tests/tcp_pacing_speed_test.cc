@@ -0,0 +1,85 @@
+#include "emulated_link.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+constexpr uint64_t transfer_len = 4'000'000;
+constexpr uint64_t one_way_delay_ms = 50;
+constexpr uint64_t bottleneck_rate = 1250; // bytes per ms: 10 Mbit/s
+
+TCPConfig config( bool pacing )
+{
+  TCPConfig cfg;
+  cfg.pacing = pacing;
+  cfg.send_capacity = 2 * cfg.recv_capacity;
+  return cfg;
+}
+
+TransferResult transfer( bool pacing, const LinkConfig& forward )
+{
+  const LinkConfig reverse { .delay_ms = one_way_delay_ms };
+  return emulated_transfer( config( pacing ), config( pacing ), forward, reverse, transfer_len );
+}
+
+double megabits_per_second( const TransferResult& result )
+{
+  return 8.0 * transfer_len / static_cast<double>( result.elapsed_ms ) / 1000.0;
+}
+
+// Behind a bottleneck whose bandwidth-delay product exceeds the window, only bursts build a queue. Windows sent
+// back to back (and slow start's two segments per ACK) pile up in it; paced ones mostly don't.
+void queue_depth()
+{
+  const LinkConfig bottleneck { .delay_ms = one_way_delay_ms, .rate = bottleneck_rate };
+  const auto bursty = transfer( false, bottleneck );
+  const auto paced = transfer( true, bottleneck );
+
+  cout << fixed << setprecision( 1 ) << "Bottleneck queue (10 Mbit/s, RTT " << 2 * one_way_delay_ms
+       << " ms): at most " << bursty.max_queue_bytes << " bytes, " << bursty.mean_queue_bytes
+       << " on average without pacing; at most " << paced.max_queue_bytes << " bytes, " << paced.mean_queue_bytes
+       << " on average with pacing (" << megabits_per_second( bursty ) << " vs. " << megabits_per_second( paced )
+       << " Mbit/s).\n";
+
+  if ( paced.max_queue_bytes * 2 > bursty.max_queue_bytes ) {
+    throw runtime_error( "pacing should at least halve the deepest queue at the bottleneck" );
+  }
+}
+
+// Behind a shallow queue, bursts overflow it and must be retransmitted
+void shallow_queue()
+{
+  const LinkConfig bottleneck { .delay_ms = one_way_delay_ms, .rate = bottleneck_rate, .queue_limit = 15'000 };
+  const auto bursty = transfer( false, bottleneck );
+  const auto paced = transfer( true, bottleneck );
+
+  cout << fixed << setprecision( 1 ) << "Shallow queue (15 KB): " << megabits_per_second( bursty ) << " Mbit/s ("
+       << bursty.segments_sent << " segments sent) without pacing, " << megabits_per_second( paced ) << " Mbit/s ("
+       << paced.segments_sent << ") with pacing.\n";
+
+  if ( paced.segments_sent > bursty.segments_sent or paced.elapsed_ms > bursty.elapsed_ms ) {
+    throw runtime_error( "pacing should lose no more segments to a shallow queue, and be no slower" );
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    queue_depth();
+    shallow_queue();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+#include "emulated_link.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+constexpr uint64_t transfer_len = 16'000'000;
+constexpr uint64_t large_capacity = 4'000'000;
+
+TCPConfig config( uint64_t capacity )
+{
+  TCPConfig cfg;
+  cfg.recv_capacity = capacity;
+  cfg.send_capacity = capacity;
+  return cfg;
+}
+
+double megabits_per_second( const TransferResult& result )
+{
+  return 8.0 * transfer_len / static_cast<double>( result.elapsed_ms ) / 1000.0;
+}
+
+// Over a lossless path with plenty of bandwidth, throughput is limited to one window per round trip
+void compare( uint64_t one_way_delay_ms )
+{
+  const LinkConfig link { .delay_ms = one_way_delay_ms };
+  const auto small = emulated_transfer(
+    config( TCPConfig::DEFAULT_CAPACITY ), config( TCPConfig::DEFAULT_CAPACITY ), link, link, transfer_len );
+  const auto large
+    = emulated_transfer( config( large_capacity ), config( large_capacity ), link, link, transfer_len );
+
+  cout << fixed << setprecision( 1 ) << "RTT " << setw( 3 ) << 2 * one_way_delay_ms
+       << " ms: " << setw( 6 ) << megabits_per_second( small ) << " Mbit/s with a 64 KB window, " << setw( 6 )
+       << megabits_per_second( large ) << " Mbit/s with a scaled " << large_capacity / 1'000'000 << " MB window.\n";
+
+  if ( large.elapsed_ms * 4 > small.elapsed_ms ) {
+    throw runtime_error( "a scaled window should be at least 4x faster at RTT " + to_string( 2 * one_way_delay_ms )
+                         + " ms" );
+  }
+}
+
+// Full-sized segments for a 1500-byte MTU carry the same transfer in a third fewer packets
+void segment_size()
+{
+  const LinkConfig link { .delay_ms = 25 };
+  TCPConfig cfg = config( large_capacity );
+  const auto small = emulated_transfer( cfg, cfg, link, link, transfer_len );
+  cfg.mss = 1460;
+  const auto full = emulated_transfer( cfg, cfg, link, link, transfer_len );
+
+  cout << "MSS " << TCPConfig::MAX_PAYLOAD_SIZE << ": " << small.segments_sent << " segments sent; MSS " << cfg.mss
+       << ": " << full.segments_sent << " segments sent.\n";
+
+  if ( full.segments_sent * 4 > small.segments_sent * 3 ) {
+    throw runtime_error( "a 1460-byte MSS should need at least 25% fewer segments" );
+  }
+}
+
+// Acknowledging every second segment (or after a short delay) halves the ACKs without slowing the transfer
+void delayed_acks()
+{
+  const LinkConfig link { .delay_ms = 25 };
+  TCPConfig cfg = config( large_capacity );
+  const auto every = emulated_transfer( cfg, cfg, link, link, transfer_len );
+  TCPConfig receiver_cfg = cfg;
+  receiver_cfg.ack_delay_ms = 40;
+  const auto delayed = emulated_transfer( cfg, receiver_cfg, link, link, transfer_len );
+
+  cout << fixed << setprecision( 1 ) << "ACK every segment: " << every.acks_sent << " ACKs, "
+       << megabits_per_second( every ) << " Mbit/s; delayed ACKs: " << delayed.acks_sent << " ACKs, "
+       << megabits_per_second( delayed ) << " Mbit/s.\n";
+
+  if ( delayed.acks_sent * 5 > every.acks_sent * 3 ) {
+    throw runtime_error( "delayed ACKs should send at least 40% fewer ACKs" );
+  }
+  if ( delayed.elapsed_ms * 10 > every.elapsed_ms * 11 ) {
+    throw runtime_error( "delayed ACKs should not slow a bulk transfer by more than 10%" );
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    for ( const uint64_t delay : { 10, 25, 50 } ) {
+      compare( delay );
+    }
+    segment_size();
+    delayed_acks();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,23 @@
+#include "eventfd.hh"
+#include "exception.hh"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <sys/eventfd.h>
+
+using namespace std;
+
+EventFD::EventFD() : FileDescriptor( ::CheckSystemCall( "eventfd", eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) ) {}
+
+void EventFD::notify()
+{
+  const uint64_t one = 1;
+  write( string_view { reinterpret_cast<const char*>( &one ), sizeof( one ) } ); // NOLINT(*-reinterpret-cast)
+}
+
+bool EventFD::consume()
+{
+  uint64_t count = 0;
+  return read( span { reinterpret_cast<char*>( &count ), sizeof( count ) } ) > 0; // NOLINT(*-reinterpret-cast)
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "file_descriptor.hh"
+
+//! A non-blocking [eventfd](\ref man2::eventfd) used by one thread to wake another that is polling it
+class EventFD : public FileDescriptor
+{
+public:
+  //! Create an eventfd with its counter at zero
+  EventFD();
+
+  //! Make the fd readable (wakes a poller); repeated notifications before consume() coalesce
+  void notify();
+
+  //! Reset the fd to unreadable
+  //! \returns `true` if there had been at least one notification since the last consume()
+  bool consume();
+};
@@ -3,6 +3,7 @@
 #include "exception.hh"
 
 #include <algorithm>
+#include <climits>
 #include <fcntl.h>
 #include <iostream>
 #include <stdexcept>
@@ -86,11 +87,20 @@ void FileDescriptor::read( string& buffer )
     buffer.resize( kReadBufferSize );
   }
 
+  buffer.resize( read( span<char> { buffer } ) );
+}
+
+// buffer is the memory to be read into; an empty buffer reads nothing (and does not signal EOF)
+size_t FileDescriptor::read( span<char> buffer )
+{
+  if ( buffer.empty() ) {
+    return 0;
+  }
+
   const ssize_t bytes_read = ::read( fd_num(), buffer.data(), buffer.size() );
   if ( bytes_read < 0 ) {
     if ( internal_fd_->non_blocking_ and ( errno == EAGAIN or errno == EINPROGRESS ) ) {
-      buffer.clear();
-      return;
+      return 0;
     }
     throw unix_error { "read" };
   }
@@ -105,7 +115,7 @@ void FileDescriptor::read( string& buffer )
     throw runtime_error( "read() read more than requested" );
   }
 
-  buffer.resize( bytes_read );
+  return bytes_read;
 }
 
 void FileDescriptor::read( vector<string>& buffers )
@@ -114,8 +124,9 @@ void FileDescriptor::read( vector<string>& buffers )
     return;
   }
 
-  buffers.back().clear();
-  buffers.back().resize( kReadBufferSize );
+  if ( buffers.back().empty() ) {
+    buffers.back().resize( kReadBufferSize );
+  }
 
   vector<iovec> iovecs;
   iovecs.reserve( buffers.size() );
@@ -168,10 +179,13 @@ size_t FileDescriptor::write( const vector<std::string>& buffers )
 
 size_t FileDescriptor::write( const vector<string_view>& buffers )
 {
+  // writev(2) rejects more than IOV_MAX buffers; write a prefix and let the caller retry with the rest
+  const size_t count = min<size_t>( buffers.size(), IOV_MAX );
+
   vector<iovec> iovecs;
-  iovecs.reserve( buffers.size() );
+  iovecs.reserve( count );
   size_t total_size = 0;
-  for ( const auto x : buffers ) {
+  for ( const auto x : span { buffers }.first( count ) ) {
     iovecs.push_back( { const_cast<char*>( x.data() ), x.size() } ); // NOLINT(*-const-cast)
     total_size += x.size();
   }
@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <span>
 #include <vector>
 
 // A reference-counted handle to a file descriptor
@@ -63,8 +64,13 @@ public:
 
   // Read into `buffer`
   void read( std::string& buffer );
+  // Scatter one read across `buffers`, filling each in turn (an empty last buffer gets the default size)
   void read( std::vector<std::string>& buffers );
 
+  // Read directly into caller-owned memory (e.g. space reserved in a ByteStream)
+  // returns number of bytes read
+  size_t read( std::span<char> buffer );
+
   // Attempt to write a buffer
   // returns number of bytes written
   size_t write( std::string_view buffer );
@@ -5,15 +5,30 @@
 #include "tcp_config.hh"
 #include "tcp_segment.hh"
 
+#include <algorithm>
+#include <chrono>
 #include <optional>
 #include <random>
+#include <span>
 #include <utility>
 
-//! An adapter class that adds random dropping behavior to an FD adapter
+//! An adapter class that adds random dropping behavior, and ECN marking at a virtual queue, to an FD adapter
 template<typename AdapterT>
 class LossyFdAdapter
 {
 private:
+  //! The bytes a bottleneck draining at FdAdapterConfig::ce_rate would hold (datagrams are not actually delayed)
+  struct VirtualQueue
+  {
+    double bytes {};
+    std::chrono::steady_clock::time_point updated { std::chrono::steady_clock::now() };
+  };
+  VirtualQueue _queue_up {};
+  VirtualQueue _queue_dn {};
+
+  static constexpr size_t HEADER_SIZE = 40; //!< IPv4 and TCP headers, counted against the queue
+
+
   //! Fast RNG used by _should_drop()
   std::default_random_engine _rand { get_random_engine() };
 
@@ -30,6 +45,28 @@ private:
     return loss != 0 && static_cast<uint16_t>( _rand() ) < loss;
   }
 
+  //! \brief Add a datagram to the virtual queue, and determine whether to mark it CE
+  //! \param[in] uplink is `true` to use the uplink queue, else the downlink queue
+  //! \returns `true` if the segment is ECN-capable and found the queue at or past the threshold
+  bool _should_mark( bool uplink, const TCPMessage& seg )
+  {
+    const auto& cfg = _adapter.config();
+    if ( cfg.ce_threshold == 0 ) {
+      return false;
+    }
+
+    VirtualQueue& queue = uplink ? _queue_up : _queue_dn;
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsed_ms = std::chrono::duration<double, std::milli>( now - queue.updated ).count();
+    queue.updated = now;
+    queue.bytes = std::max( 0.0, queue.bytes - elapsed_ms * static_cast<double>( cfg.ce_rate ) );
+
+    const bool ect = seg.sender.ecn == ECN::ECT0 or seg.sender.ecn == ECN::ECT1;
+    const bool mark = ect and queue.bytes >= cfg.ce_threshold;
+    queue.bytes += static_cast<double>( seg.sender.payload.size() + HEADER_SIZE );
+    return mark;
+  }
+
 public:
   //! Conversion to a FileDescriptor by returning the underlying AdapterT
   FileDescriptor& fd() { return _adapter.fd(); }
@@ -37,7 +74,7 @@ public:
   //! Construct from a FileDescriptor appropriate to the AdapterT constructor
   explicit LossyFdAdapter( AdapterT&& adapter ) : _adapter( std::move( adapter ) ) {}
 
-  //! \brief Read from the underlying AdapterT instance, potentially dropping the read datagram
+  //! \brief Read from the underlying AdapterT instance, potentially dropping or marking the read datagram
   //! \returns std::optional<TCPSegment> that is empty if the segment was dropped or if
   //!          the underlying AdapterT returned an empty value
   std::optional<TCPMessage> read()
@@ -46,19 +83,36 @@ public:
     if ( _should_drop( false ) ) {
       return {};
     }
+    if ( ret and _should_mark( false, *ret ) ) {
+      ret->sender.ecn = ECN::CE;
+    }
     return ret;
   }
 
-  //! \brief Write to the underlying AdapterT instance, potentially dropping the datagram to be written
+  //! \brief Write to the underlying AdapterT instance, potentially dropping or marking the datagram to be written
   //! \param[in] seg is the packet to either write or drop
   void write( const TCPMessage& seg )
   {
     if ( _should_drop( true ) ) {
       return;
     }
+    if ( _should_mark( true, seg ) ) {
+      TCPMessage marked = seg;
+      marked.sender.ecn = ECN::CE;
+      return _adapter.write( marked );
+    }
     return _adapter.write( seg );
   }
 
+  //! \brief Write a batch to the underlying AdapterT instance, dropping each datagram independently
+  //! \param[in] batch is the packets to write or drop
+  void write( std::span<TCPMessage> batch )
+  {
+    for ( const auto& seg : batch ) {
+      write( seg );
+    }
+  }
+
   //! \name
   //! Passthrough functions to the underlying AdapterT instance
 
@@ -0,0 +1,89 @@
+#include "mirrored_buffer.hh"
+#include "exception.hh"
+#include "file_descriptor.hh"
+
+#include <algorithm>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+
+using namespace std;
+
+namespace {
+void* CheckMmap( const string_view s_attempt, void* const return_value )
+{
+  if ( return_value == MAP_FAILED ) { // NOLINT(*-cstyle-cast, *-int-to-ptr)
+    throw unix_error { s_attempt };
+  }
+  return return_value;
+}
+} // namespace
+
+MirroredBuffer::MirroredBuffer( size_t min_size )
+{
+  const auto page_size = static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+  const size_t size = max( page_size, ( min_size + page_size - 1 ) / page_size * page_size );
+
+  // the memfd only has to live until both views of it are mapped
+  FileDescriptor memfd { CheckSystemCall( "memfd_create", memfd_create( "ByteStream", MFD_CLOEXEC ) ) };
+  CheckSystemCall( "ftruncate", ftruncate( memfd.fd_num(), static_cast<off_t>( size ) ) );
+
+  // reserve 2 * size of address space, then map the memfd over each half
+  auto* const base = static_cast<char*>(
+    CheckMmap( "mmap", mmap( nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 ) ) );
+  try {
+    for ( char* const half : { base, base + size } ) {
+      CheckMmap( "mmap", mmap( half, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, memfd.fd_num(), 0 ) );
+    }
+  } catch ( ... ) {
+    munmap( base, 2 * size );
+    throw;
+  }
+
+  base_ = base;
+  size_ = size;
+}
+
+MirroredBuffer::MirroredBuffer( const MirroredBuffer& other )
+{
+  if ( other.size_ > 0 ) {
+    *this = MirroredBuffer { other.size_ };
+    copy_n( other.base_, size_, base_ );
+  }
+}
+
+MirroredBuffer& MirroredBuffer::operator=( const MirroredBuffer& other )
+{
+  if ( this != &other ) {
+    *this = MirroredBuffer { other };
+  }
+  return *this;
+}
+
+MirroredBuffer::MirroredBuffer( MirroredBuffer&& other ) noexcept
+  : base_( exchange( other.base_, nullptr ) ), size_( exchange( other.size_, 0 ) )
+{}
+
+MirroredBuffer& MirroredBuffer::operator=( MirroredBuffer&& other ) noexcept
+{
+  if ( this != &other ) {
+    unmap();
+    base_ = exchange( other.base_, nullptr );
+    size_ = exchange( other.size_, 0 );
+  }
+  return *this;
+}
+
+MirroredBuffer::~MirroredBuffer()
+{
+  unmap();
+}
+
+void MirroredBuffer::unmap()
+{
+  if ( base_ ) {
+    munmap( base_, 2 * size_ );
+    base_ = nullptr;
+    size_ = 0;
+  }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+
+// A buffer of size() bytes mapped twice, back to back, so that data()[i] and data()[i + size()] are the same
+// byte. A ring kept in it never has to wrap: any region of up to size() bytes starting anywhere in the first
+// copy is contiguous.
+class MirroredBuffer
+{
+public:
+  // An empty buffer (no mapping)
+  MirroredBuffer() = default;
+
+  // Map at least `min_size` bytes, rounded up to a whole number of pages.
+  // Throws unix_error if the memfd or either mapping can't be created.
+  explicit MirroredBuffer( size_t min_size );
+
+  // Copying makes a new mapping with the same contents
+  MirroredBuffer( const MirroredBuffer& other );
+  MirroredBuffer& operator=( const MirroredBuffer& other );
+  MirroredBuffer( MirroredBuffer&& other ) noexcept;
+  MirroredBuffer& operator=( MirroredBuffer&& other ) noexcept;
+  ~MirroredBuffer();
+
+  char* data() { return base_; }
+  const char* data() const { return base_; }
+  size_t size() const { return size_; } // size of one copy; 2 * size() bytes are addressable from data()
+
+private:
+  void unmap();
+
+  char* base_ = nullptr;
+  size_t size_ = 0;
+};
@@ -28,6 +28,14 @@ class Parser
       }
     }
 
+    // Take ownership of the buffers, so that dump_all() can hand them on without copying
+    explicit BufferList( std::vector<std::string>&& buffers )
+    {
+      for ( auto& x : buffers ) {
+        append( std::move( x ) );
+      }
+    }
+
     uint64_t size() const { return size_; }
     uint64_t serialized_length() const { return size(); }
     bool empty() const { return size_ == 0; }
@@ -62,7 +70,7 @@ class Parser
       }
       std::string first_str = std::move( buffer_.front() );
       if ( skip_ ) {
-        first_str = first_str.substr( skip_ );
+        first_str.erase( 0, skip_ ); // in place; no new allocation
       }
       out.emplace_back( std::move( first_str ) );
       buffer_.pop_front();
@@ -120,6 +128,7 @@ class Parser
 
 public:
   explicit Parser( const std::vector<std::string>& input ) : input_( input ) {}
+  explicit Parser( std::vector<std::string>&& input ) : input_( std::move( input ) ) {}
 
   const BufferList& input() const { return input_; }
 
@@ -236,3 +245,12 @@ bool parse( T& obj, const std::vector<std::string>& buffers, Targs&&... Fargs )
   obj.parse( p, std::forward<Targs>( Fargs )... );
   return not p.has_error();
 }
+
+// As above, but the object may keep (move) the buffers rather than copy them, e.g. as its payload.
+template<class T, typename... Targs>
+bool parse( T& obj, std::vector<std::string>&& buffers, Targs&&... Fargs )
+{
+  Parser p { std::move( buffers ) };
+  obj.parse( p, std::forward<Targs>( Fargs )... );
+  return not p.has_error();
+}
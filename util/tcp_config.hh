@@ -13,13 +13,72 @@ class TCPConfig
 public:
   static constexpr size_t DEFAULT_CAPACITY = 64000; //!< Default capacity
   static constexpr size_t MAX_PAYLOAD_SIZE = 1000;  //!< Conservative max payload size for real Internet
+  static constexpr uint16_t DEFAULT_PEER_MSS = 536; //!< Assumed if the peer's SYN has no MSS option (RFC 9293)
+  static constexpr uint16_t MIN_MSS = 88;           //!< Smallest MSS honoured from a peer
+  static constexpr size_t TIMESTAMPS_SPACE = 12;    //!< Header bytes the timestamps option takes, with padding
   static constexpr uint16_t TIMEOUT_DFLT = 1000;    //!< Default re-transmit timeout is 1 second
   static constexpr unsigned MAX_RETX_ATTEMPTS = 8;  //!< Maximum re-transmit attempts before giving up
+  static constexpr uint8_t MAX_WINDOW_SCALE = 14;   //!< Largest window-scale shift count (RFC 7323)
+
+  //! Congestion control algorithms for TCPSender (None: limited only by the receiver's window)
+  enum class CongestionControl : uint8_t { None, NewReno, Cubic };
 
   uint16_t rt_timeout = TIMEOUT_DFLT;      //!< Initial value of the retransmission timeout, in milliseconds
+  uint16_t rt_timeout_min = 200;           //!< Lower bound on the measured retransmission timeout, in ms
+  uint16_t rt_timeout_max = 60000;         //!< Upper bound on the retransmission timeout (with backoff), in ms
   size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes
-  size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes
+  size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes (unacknowledged bytes included)
   Wrap32 isn { 137 };                      //!< Default initial sequence number
+  uint16_t mss = MAX_PAYLOAD_SIZE;         //!< Largest payload to send or receive per segment: the MSS option
+                                           //!< (set it from the link's MTU, less 40 bytes of headers)
+
+  //! Congestion control algorithm
+  CongestionControl congestion_control = CongestionControl::NewReno;
+  //! Retransmit on three duplicate ACKs and recover with NewReno fast recovery (RFC 6582), rather than waiting
+  //! for the retransmission timer
+  bool fast_retransmit = true;
+  //! Offer and use selective acknowledgments (RFC 2018), so fast recovery can repair several holes per RTT
+  //! (RFC 6675) instead of one
+  bool sack = true;
+  //! Offer the window-scale option (RFC 7323), so advertised windows can exceed 64 KiB when recv_capacity does
+  bool window_scaling = true;
+  //! Offer the timestamps option (RFC 7323): an RTT sample from every ACK, even of retransmitted data, and
+  //! protection against old segments whose sequence numbers have wrapped around (PAWS)
+  bool timestamps = true;
+  //! Pace new segments with a token bucket filled at a multiple of cwnd / SRTT, spreading each window across
+  //! the round trip instead of sending it back to back
+  bool pacing = false;
+  //! Nagle's algorithm (RFC 896): while data is unacknowledged, hold back a segment smaller than the MSS until
+  //! more is written or the ACK arrives, so a run of small writes goes out in a few full segments
+  bool nagle = false;
+  //! Delayed ACKs (RFC 1122, RFC 5681): hold the ACK of in-order data for up to this long, or until two
+  //! full-sized segments are unacknowledged; out-of-order data and FINs are acknowledged at once (0: ACK every
+  //! segment at once)
+  uint16_t ack_delay_ms = 0;
+  //! RACK-TLP (RFC 8985): deem a segment lost once one sent after it has been acknowledged and a reordering
+  //! window (a quarter of the minimum RTT) has passed, rather than counting duplicate ACKs (this part needs
+  //! SACK); and when the tail of a flight goes unacknowledged for about two SRTTs, resend its last segment as a
+  //! probe instead of waiting for the retransmission timer
+  bool rack_tlp = false;
+  //! Explicit Congestion Notification (RFC 3168): offer it on the SYN, and once both sides have, send new data
+  //! ECN-capable so a router can mark congestion (CE) instead of dropping. The receiver echoes a mark until the
+  //! sender answers it, and the sender's window responds as to a loss, at most once per window, with nothing
+  //! to retransmit.
+  bool ecn = false;
+
+  //! The window-scale shift count to offer: the smallest that fits recv_capacity into the 16-bit window field
+  //! (nullopt if window_scaling is off)
+  std::optional<uint8_t> window_scale() const
+  {
+    if ( not window_scaling ) {
+      return std::nullopt;
+    }
+    uint8_t shift = 0;
+    while ( shift < MAX_WINDOW_SCALE and ( recv_capacity >> shift ) > UINT16_MAX ) {
+      ++shift;
+    }
+    return shift;
+  }
 };
 
 //! Config for classes derived from FdAdapter
@@ -31,4 +90,10 @@ public:
 
   uint16_t loss_rate_dn = 0; //!< Downlink loss rate (for LossyFdAdapter)
   uint16_t loss_rate_up = 0; //!< Uplink loss rate (for LossyFdAdapter)
+
+  //! ECN marking (for LossyFdAdapter): each direction has a virtual queue that every datagram adds to and that
+  //! drains at `ce_rate` bytes per ms; an ECN-capable datagram that finds `ce_threshold` bytes or more queued is
+  //! marked CE (0: never)
+  uint32_t ce_rate = 0;
+  uint32_t ce_threshold = 0;
 };
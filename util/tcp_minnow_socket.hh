@@ -1,6 +1,7 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "eventfd.hh"
 #include "eventloop.hh"
 #include "file_descriptor.hh"
 #include "socket.hh"
@@ -11,6 +12,7 @@
 #include <atomic>
 #include <cstdint>
 #include <optional>
+#include <span>
 #include <thread>
 #include <vector>
 
@@ -58,6 +60,16 @@ public:
   // Return peer address from underlying datagram adapter
   const Address& peer_address() const { return _datagram_adapter.config().destination; }
 
+  //! \name
+  //! Small-segment coalescing, like the TCP_CORK and TCP_NODELAY socket options. Either may be set at any time.
+
+  //!@{
+  //! While corked, only full-sized segments are sent; uncorking sends whatever was held back
+  void set_cork( bool corked );
+  //! Send small segments at once, instead of holding them while data is unacknowledged (TCPConfig::nagle)
+  void set_nodelay( bool nodelay );
+  //!@}
+
 protected:
   //! Adapter to underlying datagram socket (e.g., UDP or IP)
   AdaptT _datagram_adapter;
@@ -72,6 +84,19 @@ private:
   //! TCP state machine
   std::optional<TCPPeer> _tcp {};
 
+  //! Options set by the owner thread, and an eventfd to tell the TCPPeer thread to apply them
+  std::atomic_bool _cork { false };
+  std::atomic_bool _nodelay { false };
+  EventFD _options_changed {};
+
+  //! Give the owner's options to the TCPPeer (on the TCPPeer thread)
+  void _apply_options();
+
+  //! Hands each batch of segments from the TCPPeer to the datagram adapter in one call
+  TCPPeer::BatchTransmitFunction _transmit { [this]( std::span<TCPMessage> batch ) {
+    _datagram_adapter.write( batch );
+  } };
+
   //! eventloop that handles all the events (new inbound datagram, new outbound bytes, new inbound bytes)
   EventLoop _eventloop {};
 
@@ -128,6 +153,13 @@ public:
   {
     TCPConfig tcp_config;
     tcp_config.rt_timeout = 100;
+    tcp_config.rt_timeout_min = 20; // the measured RTO may go well below 200 ms on local links
+    tcp_config.recv_capacity = 1 << 20; // with window scaling, a window may cover more than 64 KiB in flight
+    tcp_config.send_capacity = 2 << 20; // holds the unacknowledged window as well as the bytes still to send
+    tcp_config.mss = _datagram_adapter.mss(); // full-sized segments for the TUN device's MTU
+    tcp_config.nagle = true;                  // each chat message is a small write (see set_nodelay)
+    tcp_config.rack_tlp = true;               // and often the whole flight, so a lost one has no ACK after it
+    tcp_config.ecn = true;                    // let routers signal congestion without dropping a message
 
     FdAdapterConfig multiplexer_config;
     multiplexer_config.source = { "169.254.144.9", std::to_string( uint16_t( std::random_device()() ) ) };
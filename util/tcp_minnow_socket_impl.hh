@@ -41,7 +41,7 @@ void TCPMinnowSocket<AdaptT>::_tcp_loop( const std::function<bool()>& condition
 
     if ( _tcp.value().active() ) {
       const auto next_time = timestamp_ms();
-      _tcp.value().tick( next_time - base_time, [&]( auto x ) { _datagram_adapter.write( x ); } );
+      _tcp.value().tick( next_time - base_time, _transmit );
       _datagram_adapter.tick( next_time - base_time );
       base_time = next_time;
     }
@@ -65,10 +65,11 @@ template<TCPDatagramAdapter AdaptT>
 void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
 {
   _tcp.emplace( config );
+  _apply_options();
 
   // Set up the event loop
 
-  // There are three events to handle:
+  // There are four events to handle:
   //
   // 1) Incoming datagram received (needs to be given to TCPPeer::receive method)
   //
@@ -79,6 +80,9 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
   // 3) Incoming bytes reassembled by the Reassembler
   //    (needs to be read from the inbound_stream and written
   //    to the local stream socket back to the application)
+  //
+  // 4) The application set the cork or NODELAY option
+  //    (needs to be given to TCPPeer, which may now send what it held back)
 
   // rule 1: read from filtered packet stream and dump into TCPConnection
   _eventloop.add_rule(
@@ -87,7 +91,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     Direction::In,
     [&] {
       if ( auto seg = _datagram_adapter.read() ) {
-        _tcp->receive( std::move( seg.value() ), [&]( auto x ) { _datagram_adapter.write( x ); } );
+        _tcp->receive( std::move( seg.value() ), _transmit );
       }
 
       // debugging output:
@@ -105,10 +109,9 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     _thread_data,
     Direction::In,
     [&] {
-      std::string data;
-      data.resize( _tcp->outbound_writer().available_capacity() );
-      _thread_data.read( data );
-      _tcp->outbound_writer().push( move( data ) );
+      // read straight into the outbound stream's free space
+      Writer& outbound = _tcp->outbound_writer();
+      outbound.commit( _thread_data.read( outbound.reserve( outbound.available_capacity() ) ) );
 
       if ( _thread_data.eof() ) {
         _tcp->outbound_writer().close();
@@ -121,7 +124,8 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
                   << " still in flight).\n";
       }
 
-      _tcp->push( [&]( auto x ) { _datagram_adapter.write( x ); } );
+      _apply_options(); // after reading, so a cork set before these bytes were written applies to them
+      _tcp->push( _transmit );
     },
     [&] {
       return ( _tcp->active() ) and ( not _outbound_shutdown )
@@ -147,8 +151,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
       // the pipe, handling the possibility of a partial
       // write (i.e., only pop what was actually written).
       if ( inbound.bytes_buffered() ) {
-        const std::string_view buffer = inbound.peek();
-        const auto bytes_written = _thread_data.write( buffer );
+        const auto bytes_written = _thread_data.write( inbound.peek_all() ); // one writev even if the ring wrapped
         inbound.pop( bytes_written );
       }
 
@@ -171,6 +174,18 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
       std::cerr << "DEBUG: minnow inbound stream had error.\n";
       _tcp->inbound_reader().set_error();
     } );
+
+  // rule 4: apply the socket options
+  _eventloop.add_rule(
+    "apply socket options",
+    _options_changed,
+    Direction::In,
+    [&] {
+      _options_changed.consume();
+      _apply_options();
+      _tcp->push( _transmit );
+    },
+    [&] { return _tcp->active(); } );
 }
 
 //! \brief Call [socketpair](\ref man2::socketpair) and return connected Unix-domain sockets of specified type
@@ -217,6 +232,30 @@ void TCPMinnowSocket<AdaptT>::wait_until_closed()
   }
 }
 
+//! \param[in] corked is whether to hold back segments smaller than the MSS (applied on the TCP thread)
+template<TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::set_cork( bool corked )
+{
+  _cork.store( corked );
+  _options_changed.notify();
+}
+
+//! \param[in] nodelay is whether to send small segments at once (applied on the TCP thread)
+template<TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::set_nodelay( bool nodelay )
+{
+  _nodelay.store( nodelay );
+  _options_changed.notify();
+}
+
+//! Hand the latest socket options to the TCPPeer (on the TCP thread)
+template<TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::_apply_options()
+{
+  _tcp->set_cork( _cork.load() );
+  _tcp->set_nodelay( _nodelay.load() );
+}
+
 //! \param[in] c_tcp is the TCPConfig for the TCPConnection
 //! \param[in] c_ad is the FdAdapterConfig for the FdAdapter
 template<TCPDatagramAdapter AdaptT>
@@ -236,7 +275,7 @@ void TCPMinnowSocket<AdaptT>::connect( const TCPConfig& c_tcp, const FdAdapterCo
     throw std::runtime_error( "TCPPeer not successfully initialized" );
   }
 
-  _tcp->push( [&]( auto x ) { _datagram_adapter.write( x ); } );
+  _tcp->push( _transmit );
 
   if ( _tcp->sender().sequence_numbers_in_flight() != 1 ) {
     throw std::runtime_error( "After TCPConnection::connect(), expected sequence_numbers_in_flight() == 1" );
@@ -286,6 +325,9 @@ void TCPMinnowSocket<AdaptT>::_tcp_main()
       std::cerr << "DEBUG: minnow TCP connection finished "
                 << ( _tcp->inbound_reader().has_error() ? "uncleanly.\n" : "cleanly.\n" );
     }
+    if constexpr ( ByteStream::kCountStats ) {
+      std::cerr << "DEBUG: minnow stream stats:\n" << _tcp->stream_stats() << "\n";
+    }
     _tcp.reset();
   } catch ( const std::exception& e ) {
     std::cerr << "Exception in TCPConnection runner thread: " << e.what() << "\n";
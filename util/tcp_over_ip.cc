@@ -23,7 +23,7 @@ using namespace std;
 //! `_listen` flag and records the source and destination addresses and port numbers
 //! from the TCP header; it uses this information to filter future reads.
 //! \returns a std::optional<TCPSegment> that is empty if the segment was invalid or unrelated
-optional<TCPMessage> TCPOverIPv4Adapter::unwrap_tcp_in_ip( const InternetDatagram& ip_dgram )
+optional<TCPMessage> TCPOverIPv4Adapter::unwrap_tcp_in_ip( InternetDatagram ip_dgram )
 {
   // is the IPv4 datagram for us?
   // Note: it's valid to bind to address "0" (INADDR_ANY) and reply from actual address contacted
@@ -43,7 +43,7 @@ optional<TCPMessage> TCPOverIPv4Adapter::unwrap_tcp_in_ip( const InternetDatagra
 
   // is the payload a valid TCP segment?
   TCPSegment tcp_seg;
-  if ( not parse( tcp_seg, ip_dgram.payload, ip_dgram.header.pseudo_checksum() ) ) {
+  if ( not parse( tcp_seg, std::move( ip_dgram.payload ), ip_dgram.header.pseudo_checksum() ) ) {
     return {};
   }
 
@@ -69,7 +69,10 @@ optional<TCPMessage> TCPOverIPv4Adapter::unwrap_tcp_in_ip( const InternetDatagra
     return {};
   }
 
-  return tcp_seg.message;
+  // the ECN field is the low two bits of the type-of-service byte (RFC 3168)
+  tcp_seg.message.sender.ecn = static_cast<ECN>( ip_dgram.header.tos & 0b11U );
+
+  return std::move( tcp_seg.message );
 }
 
 //! Takes a TCP segment, sets port numbers as necessary, and wraps it in an IPv4 datagram
@@ -85,7 +88,8 @@ InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip( const TCPMessage& msg )
   InternetDatagram ip_dgram;
   ip_dgram.header.src = config().source.ipv4_numeric();
   ip_dgram.header.dst = config().destination.ipv4_numeric();
-  ip_dgram.header.len = ip_dgram.header.hlen * 4 + 20 /* tcp header len */ + seg.message.sender.payload.size();
+  ip_dgram.header.tos = static_cast<uint8_t>( msg.sender.ecn );
+  ip_dgram.header.len = ip_dgram.header.hlen * 4 + seg.header_length() + seg.message.sender.payload.size();
 
   // set payload, calculating TCP checksum using information from IP header
   seg.compute_checksum( ip_dgram.header.pseudo_checksum() );
@@ -10,7 +10,7 @@
 class TCPOverIPv4Adapter : public FdAdapterBase
 {
 public:
-  std::optional<TCPMessage> unwrap_tcp_in_ip( const InternetDatagram& ip_dgram );
+  std::optional<TCPMessage> unwrap_tcp_in_ip( InternetDatagram ip_dgram );
 
   InternetDatagram wrap_tcp_in_ip( const TCPMessage& msg );
 };
@@ -7,16 +7,17 @@
 #include "tcp_sender.hh"
 #include "tcp_sender_message.hh"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <optional>
+#include <span>
+#include <string>
+#include <vector>
 
 class TCPPeer
 {
-  auto make_send( const auto& transmit )
-  {
-    return [&]( const TCPSenderMessage& x ) { send( x, transmit ); };
-  }
-
 public:
   explicit TCPPeer( const TCPConfig& cfg ) : cfg_( cfg ) {}
 
@@ -26,20 +27,36 @@ public:
   /* Type of the `transmit` function that the push and tick methods can use to send messages */
   using TransmitFunction = std::function<void( TCPMessage )>;
 
+  /* Type of a `transmit` function that takes every message from one call at once (and may move from them) */
+  using BatchTransmitFunction = std::function<void( std::span<TCPMessage> )>;
+
   /* Passthrough methods */
-  void push( const TransmitFunction& transmit ) { sender_.push( make_send( transmit ) ); }
-  void tick( uint64_t t, const TransmitFunction& transmit )
+  void push( const BatchTransmitFunction& transmit )
+  {
+    push_segments();
+    flush( transmit );
+  }
+  void tick( uint64_t t, const BatchTransmitFunction& transmit )
   {
     cumulative_time_ += t;
-    sender_.tick( t, make_send( transmit ) );
+    sender_.tick( t, [&]( const TCPSenderMessage& x ) { send( x ); } );
+    push_segments(); // the time passed may let paced segments out
+    if ( ack_deadline_ and cumulative_time_ >= *ack_deadline_ ) {
+      send( sender_.make_empty_message() ); // a delayed ACK that no data segment carried
+    }
+    flush( transmit );
   }
   bool has_ackno() const { return receiver_.send().ackno.has_value(); }
 
+  /* Small-segment coalescing (see TCPSender::set_cork and set_nodelay); the next push or tick applies it */
+  void set_cork( bool corked ) { sender_.set_cork( corked ); }
+  void set_nodelay( bool nodelay ) { sender_.set_nodelay( nodelay ); }
+
   /* Is the peer still active? */
   bool active() const
   {
     const bool any_errors = receiver_.reader().has_error() or sender_.writer().has_error();
-    const bool sender_active = sender_.sequence_numbers_in_flight() or not sender_.reader().is_finished();
+    const bool sender_active = sender_.sequence_numbers_in_flight() or not sender_.finished_sending();
     const bool receiver_active = not receiver_.writer().is_closed();
     const bool lingering
       = linger_after_streams_finish_ and ( cumulative_time_ < time_of_last_receipt_ + 10UL * cfg_.rt_timeout );
@@ -47,7 +64,7 @@ public:
     return ( not any_errors ) and ( sender_active or receiver_active or lingering );
   }
 
-  void receive( TCPMessage msg, const TransmitFunction& transmit )
+  void receive( TCPMessage msg, const BatchTransmitFunction& transmit )
   {
     if ( not active() ) {
       return;
@@ -56,29 +73,69 @@ public:
     // Record time in case this peer has to linger after streams finish.
     time_of_last_receipt_ = cumulative_time_;
 
-    // If SenderMessage occupies a sequence number, make sure to reply.
-    need_send_ |= ( msg.sender.sequence_length() > 0 );
+    // If SenderMessage occupies a sequence number, make sure to reply (perhaps after a delay).
+    const auto our_ackno = receiver_.send().ackno;
+    if ( msg.sender.sequence_length() > 0 ) {
+      // only in-order data, filling no gap, may wait to be acknowledged (CE marks are echoed at once)
+      const bool in_order = our_ackno.has_value() and msg.sender.seqno == our_ackno.value()
+                            and receiver_.reassembler().bytes_pending() == 0;
+      if ( cfg_.ack_delay_ms > 0 and in_order and not msg.sender.FIN and not msg.sender.RST
+           and msg.sender.ecn != ECN::CE ) {
+        delay_ack( msg.sender.payload.size() );
+      } else {
+        need_send_ = true;
+      }
+    }
 
     // If SenderMessage is a "keep-alive" (with intentionally invalid seqno), make sure to reply.
     // (N.B. orthodox TCP rules require a reply on any unacceptable segment.)
-    const auto our_ackno = receiver_.send().ackno;
     need_send_ |= ( our_ackno.has_value() and msg.sender.seqno + 1 == our_ackno.value() );
 
     // Did the inbound stream finish before the outbound stream? If so, no need to linger after streams finish.
-    if ( receiver_.writer().is_closed() and not sender_.reader().is_finished() ) {
+    if ( receiver_.writer().is_closed() and not sender_.finished_sending() ) {
       linger_after_streams_finish_ = false;
     }
 
     // Give incoming TCPSenderMessage to receiver.
+    const bool syn = msg.sender.SYN;
+    const auto peer_window_scale = msg.sender.window_scale;
+    const auto peer_mss = msg.sender.mss;
+    const bool peer_timestamps = msg.sender.timestamp.has_value();
+    const bool peer_ecn = msg.sender.ecn_setup;
     receiver_.receive( std::move( msg.sender ) );
 
-    // Give incoming TCPReceiverMessage to sender.
+    // Give incoming TCPReceiverMessage to sender. The window in a SYN is never scaled, so scaling starts after.
     sender_.receive( msg.receiver );
+    if ( syn ) {
+      sender_.set_peer_window_scale( peer_window_scale );
+      sender_.set_peer_mss( peer_mss );
+      sender_.set_peer_timestamps( peer_timestamps );
+      sender_.set_peer_ecn( peer_ecn );
+    }
+
+    // The ACK may have opened the window (or called for a fast retransmit), so let the sender send.
+    push_segments();
 
     // Send reply if needed.
     if ( need_send_ ) {
-      send( sender_.make_empty_message(), transmit );
+      send( sender_.make_empty_message() );
     }
+    flush( transmit );
+  }
+
+  /* The same, handing the messages to `transmit` one at a time */
+  void push( const TransmitFunction& transmit ) { push( one_at_a_time( transmit ) ); }
+  void tick( uint64_t t, const TransmitFunction& transmit ) { tick( t, one_at_a_time( transmit ) ); }
+  void receive( TCPMessage msg, const TransmitFunction& transmit )
+  {
+    receive( std::move( msg ), one_at_a_time( transmit ) );
+  }
+
+  // ByteStream counters for the outbound (send) and inbound (receive) streams; see ByteStream::Stats
+  std::string stream_stats() const
+  {
+    return "outbound " + sender_.reader().stats().to_string() + "\n"
+           + "inbound " + receiver_.reader().stats().to_string();
   }
 
   // Testing interface
@@ -87,16 +144,81 @@ public:
 
 private:
   TCPConfig cfg_;
-  TCPSender sender_ { ByteStream { cfg_.send_capacity }, cfg_.isn, cfg_.rt_timeout };
-  TCPReceiver receiver_ { Reassembler { ByteStream { cfg_.recv_capacity } } };
+  TCPSender sender_ { ByteStream { cfg_.send_capacity }, cfg_ };
+  // in Chunks mode, in-order payloads are moved into the inbound stream rather than copied
+  TCPReceiver receiver_ { Reassembler { ByteStream { cfg_.recv_capacity, ByteStream::Mode::Chunks } },
+                          cfg_.window_scale() };
 
   bool need_send_ {};
 
-  void send( const TCPSenderMessage& sender_message, const TransmitFunction& transmit )
+  // Delayed ACKs
+  uint64_t unacked_bytes_ {};               // in-order payload received since our last segment
+  uint64_t rcv_mss_ {};                     // the largest payload received: taken to be a full-sized segment
+  std::optional<uint64_t> ack_deadline_ {}; // when the ACK must go even if nothing else does
+
+  void delay_ack( uint64_t payload_size )
+  {
+    unacked_bytes_ += payload_size;
+    rcv_mss_ = std::max( rcv_mss_, payload_size );
+    if ( unacked_bytes_ >= 2 * rcv_mss_ ) {
+      need_send_ = true; // every second full-sized segment is acknowledged at once
+    } else if ( not ack_deadline_ ) {
+      ack_deadline_ = cumulative_time_ + cfg_.ack_delay_ms;
+    }
+  }
+
+  std::vector<TCPMessage> outbox_ {}; // messages made since the last flush()
+
+  static BatchTransmitFunction one_at_a_time( const TransmitFunction& transmit )
+  {
+    return [&]( std::span<TCPMessage> batch ) {
+      for ( auto& msg : batch ) {
+        transmit( std::move( msg ) );
+      }
+    };
+  }
+
+  // let the sender fill the window, and wrap what it sends into the outbox
+  void push_segments()
+  {
+    sender_.push( [&]( TCPSender::Batch batch ) {
+      for ( const TCPSenderMessage& x : batch ) {
+        send( x );
+      }
+    } );
+  }
+
+  // hand everything in the outbox to `transmit` in one call
+  void flush( const BatchTransmitFunction& transmit )
+  {
+    if ( not outbox_.empty() ) {
+      transmit( outbox_ );
+      outbox_.clear();
+    }
+  }
+
+  void send( const TCPSenderMessage& sender_message )
   {
     TCPMessage msg { sender_message, receiver_.send() };
-    transmit( std::move( msg ) );
+    if ( sender_message.SYN ) {
+      // RFC 7323: the window field of a SYN is never scaled
+      msg.receiver.window_size
+        = static_cast<uint16_t>( std::min<uint64_t>( receiver_.writer().available_capacity(), UINT16_MAX ) );
+    }
+    if ( not sender_message.payload.empty() ) {
+      // options come out of the MSS (RFC 6691): keep only the SACK blocks that fit beside the payload
+      auto& blocks = msg.receiver.sack_blocks;
+      const uint64_t timestamps = msg.sender.timestamp ? TCPConfig::TIMESTAMPS_SPACE : 0;
+      const uint64_t room = sender_.mss() - std::min( sender_.mss(), sender_message.payload.size() + timestamps );
+      const uint64_t fit = room >= 4 ? ( room - 4 ) / 8 : 0; // 4: NOP, NOP, kind, length
+      if ( blocks.size() > fit ) {
+        blocks.erase( blocks.begin() + static_cast<ptrdiff_t>( fit ), blocks.end() );
+      }
+    }
+    outbox_.push_back( std::move( msg ) );
     need_send_ = false;
+    unacked_bytes_ = 0; // every segment carries the latest ACK
+    ack_deadline_.reset();
   }
 
   bool linger_after_streams_finish_ { true }; // one peer may need to linger to make sure all closure conditions met
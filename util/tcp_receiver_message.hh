@@ -2,26 +2,45 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <utility>
+#include <vector>
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
  *
- * It contains three fields:
+ * It contains these fields:
  *
  * 1) The acknowledgment number (ackno): the *next* sequence number needed by the TCP Receiver.
  *    This is an optional field that is empty if the TCPReceiver hasn't yet received the Initial Sequence Number.
  *
  * 2) The window size. This is the number of sequence numbers that the TCP receiver is interested
  *    to receive, starting from the ackno if present. The maximum value is 65,535 (UINT16_MAX from
- *    the <cstdint> header).
+ *    the <cstdint> header). If both SYNs carried the window-scale option, it counts units of 2^shift
+ *    sequence numbers instead, where shift is what the receiver's side offered.
  *
  * 3) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
+ *
+ * 4) Selective acknowledgments (RFC 2018), if the peer's SYN permitted them: up to MAX_SACK_BLOCKS ranges
+ *    [left, right) of sequence numbers received beyond the ackno. The first covers the most recent arrival.
+ *
+ * 5) The timestamp echo (TSecr), with timestamps: the TSval of the latest segment that advanced the ackno,
+ *    echoed back so the peer's sender can measure the round-trip time.
+ *
+ * 6) The ECE flag (ECN-Echo, RFC 3168): a segment arrived marked CE, and the peer's sender has not yet answered
+ *    with CWR.
  */
 
 struct TCPReceiverMessage
 {
+  static constexpr size_t MAX_SACK_BLOCKS = 4; // as many as fit in 40 bytes of options (3 beside timestamps)
+
   std::optional<Wrap32> ackno {};
   uint16_t window_size {};
   bool RST {};
+  std::vector<std::pair<Wrap32, Wrap32>> sack_blocks {};
+  std::optional<uint32_t> timestamp_echo {};
+  bool ECE {};
 };
@@ -3,11 +3,106 @@
 #include "wrapping_integers.hh"
 
 #include <cstddef>
+#include <string>
+#include <vector>
 
-static constexpr uint32_t TCPHeaderMinLen = 5; // 32-bit words
+static constexpr uint32_t TCPHeaderMinLen = 5;  // 32-bit words
+static constexpr uint32_t TCPOptionsMaxLen = 40; // bytes
 
 using namespace std;
 
+namespace {
+
+// TCP option kinds
+enum : uint8_t
+{
+  OPT_EOL = 0,
+  OPT_NOP = 1,
+  OPT_MSS = 2,
+  OPT_WINDOW_SCALE = 3,
+  OPT_SACK_PERMITTED = 4,
+  OPT_SACK = 5,
+  OPT_TIMESTAMPS = 8,
+};
+
+// Read the options that the stack understands, and skip the others
+void parse_options( string raw, TCPMessage& message )
+{
+  Parser parser { vector<string> { move( raw ) } };
+  while ( parser.input().size() > 0 ) {
+    uint8_t kind {};
+    parser.integer( kind );
+    if ( kind == OPT_EOL ) {
+      return;
+    }
+    if ( kind == OPT_NOP ) {
+      continue;
+    }
+
+    uint8_t len {};
+    parser.integer( len );
+    const bool too_short = len < ( kind == OPT_TIMESTAMPS     ? 10
+                                   : kind == OPT_MSS          ? 4
+                                   : kind == OPT_WINDOW_SCALE ? 3
+                                                              : 2 );
+    if ( parser.has_error() or too_short or len - 2U > parser.input().size() ) {
+      return; // malformed: ignore the rest
+    }
+
+    switch ( kind ) {
+      case OPT_MSS: {
+        uint16_t mss {};
+        parser.integer( mss );
+        message.sender.mss = mss;
+        parser.remove_prefix( len - 4U );
+        break;
+      }
+
+      case OPT_WINDOW_SCALE: {
+        uint8_t shift {};
+        parser.integer( shift );
+        message.sender.window_scale = shift;
+        parser.remove_prefix( len - 3U );
+        break;
+      }
+
+      case OPT_TIMESTAMPS: {
+        uint32_t value {};
+        uint32_t echo {};
+        parser.integer( value );
+        parser.integer( echo );
+        message.sender.timestamp = value;
+        if ( message.receiver.ackno.has_value() ) { // TSecr is only valid with ACK
+          message.receiver.timestamp_echo = echo;
+        }
+        parser.remove_prefix( len - 10U );
+        break;
+      }
+
+      case OPT_SACK_PERMITTED:
+        message.sender.sack_permitted = true;
+        parser.remove_prefix( len - 2U );
+        break;
+
+      case OPT_SACK:
+        for ( unsigned i = 0; i < ( len - 2U ) / 8; ++i ) {
+          uint32_t left {};
+          uint32_t right {};
+          parser.integer( left );
+          parser.integer( right );
+          message.receiver.sack_blocks.emplace_back( Wrap32 { left }, Wrap32 { right } );
+        }
+        parser.remove_prefix( ( len - 2U ) % 8 );
+        break;
+
+      default:
+        parser.remove_prefix( len - 2U );
+    }
+  }
+}
+
+} // namespace
+
 void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum )
 {
   /* verify checksum */
@@ -43,15 +138,30 @@ void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum
   message.sender.SYN = octet & 0b0000'0010;
   message.sender.FIN = octet & 0b0000'0001;
 
+  // RFC 3168: a SYN offers ECN with ECE and CWR, a SYN-ACK accepts it with ECE alone
+  const bool ece = octet & 0b0100'0000;
+  const bool cwr = octet & 0b1000'0000;
+  if ( message.sender.SYN ) {
+    message.sender.ecn_setup = ece and ( message.receiver.ackno.has_value() ? not cwr : cwr );
+  } else {
+    message.receiver.ECE = ece and message.receiver.ackno.has_value();
+    message.sender.CWR = cwr;
+  }
+
   parser.integer( message.receiver.window_size );
   parser.integer( udinfo.cksum );
   parser.integer( raw16 ); // urgent pointer
 
-  // skip any options or anything extra in the header
   if ( data_offset < TCPHeaderMinLen ) {
     parser.set_error();
+    return;
+  }
+  string options( data_offset * 4 - TCPHeaderMinLen * 4, 0 );
+  parser.string( options );
+  if ( parser.has_error() ) {
+    return;
   }
-  parser.remove_prefix( data_offset * 4 - TCPHeaderMinLen * 4 );
+  parse_options( move( options ), message );
 
   parser.all_remaining( message.sender.payload );
 }
@@ -62,20 +172,84 @@ public:
   uint32_t raw_value() const { return raw_value_; }
 };
 
+namespace {
+
+// Append one option, after enough NOPs to keep it (and so everything after it) 32-bit aligned
+void append_option( string& options, uint8_t kind, const string& body = {} )
+{
+  const size_t len = 2 + body.size();
+  options.append( ( 4 - len % 4 ) % 4, static_cast<char>( OPT_NOP ) );
+  options.push_back( static_cast<char>( kind ) );
+  options.push_back( static_cast<char>( len ) );
+  options.append( body );
+}
+
+string make_options( const TCPMessage& message )
+{
+  string options;
+  if ( message.sender.SYN and message.sender.mss.has_value() ) {
+    Serializer mss;
+    mss.integer( *message.sender.mss );
+    append_option( options, OPT_MSS, mss.output().front() );
+  }
+  if ( message.sender.SYN and message.sender.sack_permitted ) {
+    append_option( options, OPT_SACK_PERMITTED );
+  }
+  if ( message.sender.SYN and message.sender.window_scale.has_value() ) {
+    append_option( options, OPT_WINDOW_SCALE, string( 1, static_cast<char>( *message.sender.window_scale ) ) );
+  }
+
+  if ( message.sender.timestamp.has_value() ) {
+    Serializer timestamps;
+    timestamps.integer( *message.sender.timestamp );
+    timestamps.integer( message.receiver.timestamp_echo.value_or( 0 ) );
+    append_option( options, OPT_TIMESTAMPS, timestamps.output().front() );
+  }
+
+  if ( message.receiver.ackno.has_value() and not message.receiver.sack_blocks.empty() ) {
+    const size_t room = ( TCPOptionsMaxLen - options.size() - 4 ) / 8; // 4: NOP, NOP, kind, length
+    Serializer blocks;
+    for ( size_t i = 0; i < min( room, message.receiver.sack_blocks.size() ); ++i ) {
+      blocks.integer( Wrap32Serializable { message.receiver.sack_blocks[i].first }.raw_value() );
+      blocks.integer( Wrap32Serializable { message.receiver.sack_blocks[i].second }.raw_value() );
+    }
+    if ( not blocks.output().empty() ) {
+      append_option( options, OPT_SACK, blocks.output().front() );
+    }
+  }
+
+  return options;
+}
+
+} // namespace
+
+size_t TCPSegment::header_length() const
+{
+  return TCPHeaderMinLen * 4 + make_options( message ).size();
+}
+
 void TCPSegment::serialize( Serializer& serializer ) const
 {
   serializer.integer( udinfo.src_port );
   serializer.integer( udinfo.dst_port );
   serializer.integer( Wrap32Serializable { message.sender.seqno }.raw_value() );
   serializer.integer( Wrap32Serializable { message.receiver.ackno.value_or( Wrap32 { 0 } ) }.raw_value() );
-  serializer.integer( uint8_t { TCPHeaderMinLen << 4 } ); // data offset
+  const string options = make_options( message );
+  serializer.integer( static_cast<uint8_t>( ( TCPHeaderMinLen + options.size() / 4 ) << 4 ) ); // data offset
   const bool reset = message.sender.RST or message.receiver.RST;
-  const uint8_t flags = ( message.receiver.ackno.has_value() ? 0b0001'0000U : 0 ) | ( reset ? 0b0000'0100U : 0 )
-                        | ( message.sender.SYN ? 0b0000'0010U : 0 ) | ( message.sender.FIN ? 0b0000'0001U : 0 );
+  const bool ack = message.receiver.ackno.has_value();
+  const bool ece = message.sender.SYN ? message.sender.ecn_setup : ( message.receiver.ECE and ack );
+  const bool cwr = message.sender.SYN ? ( message.sender.ecn_setup and not ack ) : message.sender.CWR;
+  const uint8_t flags = ( cwr ? 0b1000'0000U : 0 ) | ( ece ? 0b0100'0000U : 0 ) | ( ack ? 0b0001'0000U : 0 )
+                        | ( reset ? 0b0000'0100U : 0 ) | ( message.sender.SYN ? 0b0000'0010U : 0 )
+                        | ( message.sender.FIN ? 0b0000'0001U : 0 );
   serializer.integer( flags );
   serializer.integer( message.receiver.window_size );
   serializer.integer( udinfo.cksum );
   serializer.integer( uint16_t { 0 } ); // urgent pointer
+  for ( const char c : options ) {
+    serializer.integer( static_cast<uint8_t>( c ) );
+  }
   serializer.buffer( message.sender.payload );
 }
 
@@ -19,5 +19,8 @@ struct TCPSegment
   void parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum );
   void serialize( Serializer& serializer ) const;
 
+  // Length in bytes of the serialized TCP header, options included
+  size_t header_length() const;
+
   void compute_checksum( uint32_t datagram_layer_pseudo_checksum );
 };
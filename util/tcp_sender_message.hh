@@ -2,12 +2,23 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstdint>
+#include <optional>
 #include <string>
 
+// The ECN field of the IP header that carries a segment (RFC 3168)
+enum class ECN : uint8_t
+{
+  NotECT = 0b00, // not ECN-capable
+  ECT1 = 0b01,   // ECN-capable
+  ECT0 = 0b10,   // ECN-capable (what this stack sends)
+  CE = 0b11,     // a router on the way marked congestion
+};
+
 /*
  * The TCPSenderMessage structure contains the information sent from a TCP sender to its receiver.
  *
- * It contains five fields:
+ * It contains these fields:
  *
  * 1) The sequence number (seqno) of the beginning of the segment. If the SYN flag is set, this is the
  *    sequence number of the SYN flag. Otherwise, it's the sequence number of the beginning of the payload.
@@ -20,6 +31,25 @@
  * 4) The FIN flag. If set, the payload represents the ending of the byte stream.
  *
  * 5) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
+ *
+ * 6) The MSS (only on a SYN, and optional): the largest payload the sender's side can receive in one segment.
+ *
+ * 7) The SACK-permitted flag (only on a SYN). If set, the sender will accept selective acknowledgments
+ *    (RFC 2018) from the peer's receiver.
+ *
+ * 8) The window-scale shift count (only on a SYN, and optional): the sender's side offers to advertise its
+ *    receiver's windows in units of 2^shift sequence numbers (RFC 7323).
+ *
+ * 9) The timestamp (TSval, optional): the sender's clock, in milliseconds, when the segment was sent. A SYN
+ *    with one offers the timestamps option; if both SYNs did, every segment carries one (RFC 7323).
+ *
+ * 10) The ECN-setup flag (only on a SYN). If set, the SYN offers Explicit Congestion Notification (RFC 3168);
+ *     once both SYNs have, new data goes out ECN-capable (ECT).
+ *
+ * 11) The CWR (congestion window reduced) flag. If set, the sender has reduced its window in answer to an echoed
+ *     CE mark, so the peer's receiver can stop echoing it.
+ *
+ * 12) The ECN codepoint (ecn). Not part of the TCP header but the IP header's ECN field, as sent or as received.
  */
 
 struct TCPSenderMessage
@@ -32,6 +62,14 @@ struct TCPSenderMessage
 
   bool RST {};
 
+  std::optional<uint16_t> mss {};         // only meaningful with SYN
+  bool sack_permitted {};                  // only meaningful with SYN
+  std::optional<uint8_t> window_scale {}; // only meaningful with SYN
+  std::optional<uint32_t> timestamp {};   // TSval, in milliseconds
+  bool ecn_setup {};                      // only meaningful with SYN: offers ECN
+  bool CWR {};                            // congestion window reduced
+  ECN ecn {};                             // from the IP header
+
   // How many sequence numbers does this segment use?
   size_t sequence_length() const { return SYN + payload.size() + FIN; }
 };
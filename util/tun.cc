@@ -6,6 +6,7 @@
 #include <linux/if.h>
 #include <linux/if_tun.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 
 static constexpr const char* CLONEDEV = "/dev/net/tun";
 
@@ -22,7 +23,7 @@ using namespace std;
 //! as root before calling this function.
 
 TunTapFD::TunTapFD( const string& devname, const bool is_tun )
-  : FileDescriptor( ::CheckSystemCall( "open", open( CLONEDEV, O_RDWR | O_CLOEXEC ) ) )
+  : FileDescriptor( ::CheckSystemCall( "open", open( CLONEDEV, O_RDWR | O_CLOEXEC ) ) ), devname_( devname )
 {
   struct ifreq tun_req
   {};
@@ -36,3 +37,17 @@ TunTapFD::TunTapFD( const string& devname, const bool is_tun )
 
   CheckSystemCall( "ioctl", ioctl( fd_num(), TUNSETIFF, static_cast<void*>( &tun_req ) ) );
 }
+
+size_t TunTapFD::mtu() const
+{
+  // the MTU is an interface setting, queried through any socket rather than the TUN file descriptor itself
+  const FileDescriptor sock { CheckSystemCall( "socket", socket( AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0 ) ) };
+
+  struct ifreq req
+  {};
+  strncpy( static_cast<char*>( req.ifr_name ), devname_.data(), IFNAMSIZ - 1 );
+  req.ifr_name[IFNAMSIZ - 1] = '\0';
+
+  CheckSystemCall( "ioctl", ioctl( sock.fd_num(), SIOCGIFMTU, static_cast<void*>( &req ) ) );
+  return static_cast<size_t>( req.ifr_mtu );
+}
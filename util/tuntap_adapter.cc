@@ -1,21 +1,69 @@
 #include "tuntap_adapter.hh"
 #include "parser.hh"
 
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
 using namespace std;
 
+namespace {
+constexpr size_t kTCPHeaderLength = 20; // without options
+
+// The TCP header length (with options) of a datagram read into `strs`, if it carries a TCP payload after a
+// 20-byte IPv4 header
+optional<size_t> tcp_header_length( const vector<string>& strs )
+{
+  if ( strs.size() != 3 or strs[0].size() != IPv4Header::LENGTH or strs[2].empty()
+       or ( static_cast<uint8_t>( strs[0][0] ) & 0xfU ) * 4U != IPv4Header::LENGTH ) {
+    return {};
+  }
+  const size_t data_offset = 4U * ( static_cast<uint8_t>( strs[1].at( 12 ) ) >> 4U );
+  if ( data_offset < kTCPHeaderLength or data_offset >= strs[1].size() + strs[2].size() ) {
+    return {};
+  }
+  return data_offset;
+}
+} // namespace
+
+uint16_t TCPOverIPv4OverTunFdAdapter::mss() const
+{
+  return static_cast<uint16_t>( min<size_t>( _mtu - IPv4Header::LENGTH - kTCPHeaderLength, UINT16_MAX ) );
+}
+
 optional<TCPMessage> TCPOverIPv4OverTunFdAdapter::read()
 {
-  vector<string> strs( 2 );
-  strs.front().resize( IPv4Header::LENGTH );
+  // Read the IPv4 header, the TCP header, and the rest into separate buffers. When the TCP header is as long as
+  // the last data segment's (options included, e.g. 32 bytes with timestamps), the last buffer then holds exactly
+  // the TCP payload and is moved (not copied or shifted) all the way into the TCPMessage.
+  vector<string> strs( 3 );
+  strs.at( 0 ).resize( IPv4Header::LENGTH );
+  strs.at( 1 ).resize( _tcp_header_length );
+  strs.at( 2 ).resize( _mtu - IPv4Header::LENGTH - _tcp_header_length );
   _tun.read( strs );
 
+  // the peer's data segments all carry the same options, so size the next read for this one's header
+  if ( const auto header_length = tcp_header_length( strs ) ) {
+    _tcp_header_length = *header_length;
+  }
+
   InternetDatagram ip_dgram;
-  const vector<string> buffers = { strs.at( 0 ), strs.at( 1 ) };
-  if ( parse( ip_dgram, buffers ) ) {
-    return unwrap_tcp_in_ip( ip_dgram );
+  if ( parse( ip_dgram, std::move( strs ) ) ) {
+    return unwrap_tcp_in_ip( std::move( ip_dgram ) );
   }
   return {};
 }
 
+//! \details A TUN device takes exactly one packet per write() (a writev() is also one packet), so the
+//! datagrams still go out one syscall each; the batch saves the per-segment trips through the event loop.
+void TCPOverIPv4OverTunFdAdapter::write( span<TCPMessage> batch )
+{
+  for ( const auto& seg : batch ) {
+    write( seg );
+  }
+}
+
 //! Specialize LossyFdAdapter to TCPOverIPv4OverTunFdAdapter
 template class LossyFdAdapter<TCPOverIPv4OverTunFdAdapter>;
@@ -4,14 +4,19 @@
 #include "tcp_segment.hh"
 #include "tun.hh"
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <span>
 #include <unordered_map>
 #include <utility>
 
 template<class T>
-concept TCPDatagramAdapter = requires( T a, TCPMessage seg ) {
+concept TCPDatagramAdapter = requires( T a, TCPMessage seg, std::span<TCPMessage> batch ) {
   { a.write( seg ) } -> std::same_as<void>;
 
+  { a.write( batch ) } -> std::same_as<void>;
+
   { a.read() } -> std::same_as<std::optional<TCPMessage>>;
 };
 
@@ -20,10 +25,18 @@ class TCPOverIPv4OverTunFdAdapter : public TCPOverIPv4Adapter
 {
 private:
   TunFD _tun;
+  size_t _mtu;
+  size_t _tcp_header_length = 20; //!< TCP header bytes to read separately from the payload
 
 public:
   //! Construct from a TunFD
-  explicit TCPOverIPv4OverTunFdAdapter( TunFD&& tun ) : _tun( std::move( tun ) ) {}
+  explicit TCPOverIPv4OverTunFdAdapter( TunFD&& tun ) : _tun( std::move( tun ) ), _mtu( _tun.mtu() ) {}
+
+  //! The TUN device's MTU, in bytes
+  size_t mtu() const { return _mtu; }
+
+  //! The largest TCP payload that fits in one datagram without options: the MSS to advertise
+  uint16_t mss() const;
 
   //! Attempts to read and parse an IPv4 datagram containing a TCP segment related to the current connection
   std::optional<TCPMessage> read();
@@ -31,6 +44,9 @@ public:
   //! Creates an IPv4 datagram from a TCP segment and writes it to the TUN device
   void write( const TCPMessage& seg ) { _tun.write( serialize( wrap_tcp_in_ip( seg ) ) ); }
 
+  //! Writes each of a batch of TCP segments to the TUN device
+  void write( std::span<TCPMessage> batch );
+
   //! Access the underlying TUN device
   explicit operator TunFD&() { return _tun; }
 